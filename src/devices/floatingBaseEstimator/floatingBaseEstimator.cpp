@@ -11,6 +11,7 @@
 
 #include <iDynTree/yarp/YARPConversions.h>
 #include <iDynTree/Core/Utils.h>
+#include <iDynTree/Model/Traversal.h>
 
 #include <cassert>
 #include <cmath>
@@ -26,7 +27,10 @@ floatingBaseEstimator::floatingBaseEstimator(): RateThread(10),
                                                 portPrefix("/floatingBaseEstimator"),
                                                 correctlyConfigured(false),
                                                 sensorReadCorrectly(false),
-                                                estimationWentWell(false)
+                                                estimationWentWell(false),
+                                                kinematicsCacheValid(false),
+                                                worldBaseTransformValid(false),
+                                                kinematicsCacheThreshold(0.0)
 {
 }
 
@@ -184,6 +188,7 @@ void floatingBaseEstimator::resizeBuffers()
 {
     this->jointPos.resize(estimator.model());
     this->jointVelSetToZero.resize(estimator.model());
+    this->cachedJointPos.resize(estimator.model());
 
     this->homMatrixBuffer.resize(4,4);
 }
@@ -215,6 +220,16 @@ bool floatingBaseEstimator::loadSettingsFromConfig(os::Searchable& config)
         initialWorldFrame = initialFixedFrame;
     }
 
+    if( prop.check("kinematicsCacheThreshold") )
+    {
+        kinematicsCacheThreshold = prop.find("kinematicsCacheThreshold").asDouble();
+        if( kinematicsCacheThreshold < 0.0 )
+        {
+            yError() << "floatingBaseEstimator : kinematicsCacheThreshold should be non-negative";
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -315,6 +330,70 @@ void floatingBaseEstimator::readSensors()
 void floatingBaseEstimator::updateKinematics()
 {
     estimationWentWell = estimator.updateKinematics(jointPos);
+
+    cachedJointPos = jointPos;
+    worldBaseTransformValid = false;
+}
+
+void floatingBaseEstimator::invalidateKinematicsCache()
+{
+    kinematicsCacheValid = false;
+    worldBaseTransformValid = false;
+}
+
+void floatingBaseEstimator::computeFixedLinkToBaseDOFs()
+{
+    const iDynTree::Model & model = estimator.model();
+
+    fixedLinkToBaseDOFs.clear();
+
+    // Walk from the base link to the fixed link, using a traversal rooted in the fixed link
+    iDynTree::Traversal traversal;
+    model.computeFullTreeTraversal(traversal,model.getLinkIndex(estimator.getCurrentFixedLink()));
+
+    iDynTree::LinkIndex link = model.getDefaultBaseLink();
+    while( traversal.getParentLinkFromLinkIndex(link) )
+    {
+        iDynTree::IJointConstPtr joint = traversal.getParentJointFromLinkIndex(link);
+        for(unsigned int dof=0; dof < joint->getNrOfDOFs(); dof++)
+        {
+            fixedLinkToBaseDOFs.push_back(joint->getDOFsOffset()+dof);
+        }
+        link = traversal.getParentLinkFromLinkIndex(link)->getIndex();
+    }
+}
+
+bool floatingBaseEstimator::kinematicsChanged()
+{
+    // The fixed link is changed only by the RPC methods, that invalidate the cache
+    if( !kinematicsCacheValid )
+    {
+        computeFixedLinkToBaseDOFs();
+        kinematicsCacheValid = true;
+        return true;
+    }
+
+    for(size_t i=0; i < fixedLinkToBaseDOFs.size(); i++)
+    {
+        size_t dof = fixedLinkToBaseDOFs[i];
+        if( std::fabs(jointPos(dof)-cachedJointPos(dof)) > kinematicsCacheThreshold )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const iDynTree::Transform & floatingBaseEstimator::getWorldBaseTransform()
+{
+    if( !worldBaseTransformValid )
+    {
+        cachedWorld_H_base = this->estimator.getWorldLinkTransform(this->estimator.model().getDefaultBaseLink());
+        worldBaseTransformValid = true;
+    }
+
+    return cachedWorld_H_base;
 }
 
 void floatingBaseEstimator::publishEstimatedQuantities()
@@ -335,8 +414,7 @@ void floatingBaseEstimator::publishFloatingBasePosIniCubGuiFormat()
     // TODO this is quite an hack, and should be moved to a better place
     // (a portmonitor on the port?)
 
-    iDynTree::Transform world_H_base
-        = this->estimator.getWorldLinkTransform(this->estimator.model().getDefaultBaseLink());
+    const iDynTree::Transform & world_H_base = this->getWorldBaseTransform();
 
     double roll,pitch,yaw;
 
@@ -366,8 +444,7 @@ void floatingBaseEstimator::publishFloatingBasePosIniCubGuiFormat()
 
 void floatingBaseEstimator::publishFloatingBasePosInWBIFormat()
 {
-    iDynTree::Transform world_H_base
-        = this->estimator.getWorldLinkTransform(this->estimator.model().getDefaultBaseLink());
+    const iDynTree::Transform & world_H_base = this->getWorldBaseTransform();
 
     iDynTree::toYarp(world_H_base.asHomogeneousTransform(),this->homMatrixBuffer);
 
@@ -404,12 +481,16 @@ void floatingBaseEstimator::run()
             // first run, configure the estimator
             this->updateKinematics();
             correctlyConfigured = this->estimator.init(initialFixedFrame,initialWorldFrame);
+            this->invalidateKinematicsCache();
         }
 
         if( correctlyConfigured )
         {
-            // Update kinematics
-            this->updateKinematics();
+            // Update kinematics, only if the floating base could have moved
+            if( this->kinematicsChanged() )
+            {
+                this->updateKinematics();
+            }
 
             // Publish estimated quantities
             this->publishEstimatedQuantities();
@@ -456,7 +537,11 @@ bool floatingBaseEstimator::resetSimpleLeggedOdometry(const std::string& initial
                                                       const std::string& initial_fixed_frame)
 {
     yarp::os::LockGuard guard(this->deviceMutex);
-    return this->estimator.init(initial_fixed_frame,initial_world_frame);
+    // The estimator is initialized with the last joint positions read, not the cached ones
+    this->updateKinematics();
+    bool ok = this->estimator.init(initial_fixed_frame,initial_world_frame);
+    this->invalidateKinematicsCache();
+    return ok;
 }
 
 iDynTree::Transform thrift2iDynTree(const codyco::HomTransform& thriftTrans)
@@ -492,14 +577,20 @@ bool floatingBaseEstimator::resetSimpleLeggedOdometryToArbitraryFrame(const std:
 {
     iDynTree::Transform initial_reference_frame_H_world = thrift2iDynTree(initial_reference_frame_H_world_thrift);
     yarp::os::LockGuard guard(this->deviceMutex);
-    return this->estimator.init(initial_fixed_frame,initial_reference_frame,initial_reference_frame_H_world);
+    this->updateKinematics();
+    bool ok = this->estimator.init(initial_fixed_frame,initial_reference_frame,initial_reference_frame_H_world);
+    this->invalidateKinematicsCache();
+    return ok;
 }
 
 
 bool floatingBaseEstimator::changeFixedLinkSimpleLeggedOdometry(const std::string& new_fixed_frame)
 {
     yarp::os::LockGuard guard(this->deviceMutex);
-    return this->estimator.changeFixedFrame(new_fixed_frame);
+    this->updateKinematics();
+    bool ok = this->estimator.changeFixedFrame(new_fixed_frame);
+    this->invalidateKinematicsCache();
+    return ok;
 }
 
 std::string floatingBaseEstimator::getCurrentSettingsString()
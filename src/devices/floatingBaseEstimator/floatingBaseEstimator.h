@@ -33,6 +33,7 @@ namespace dev {
  * | modelFile      |      -         | path to file      |   -   | model.urdf    | No       | Path to the URDF file used for the kinematic and dynamic model.   |       |
  * | initialFixedFrame  | string | - | - | Yes | Name of a frame attached to the link that is assumed to be fixed at start | - |
  * | initialWorldFrame | string | - | Equal to initialFixedFrame | No | Name of the frame of the model that is supposed to be coincident with the world/inertial frame at start | - |
+ * | kinematicsCacheThreshold | double | rad | 0.0 | No | The kinematics is updated only if a joint between the fixed link and the base link moved more than this threshold since the last update | With 0.0 the estimates are the same as updating the kinematics at every cycle |
  *
  * The axes contained in the axesNames parameter are then mapped to the wrapped controlboard in the attachAll method, using controlBoardRemapper class.
  * Furthermore are also used to match the yarp axes to the joint names found in the passed URDF file.
@@ -138,6 +139,31 @@ private:
     void readSensors();
     void updateKinematics();
 
+    /**
+     * Return true if the kinematics has to be updated, i.e. if a joint in the chain
+     * from the current fixed link to the base link moved more than kinematicsCacheThreshold
+     * since the last call to updateKinematics (or if the cache was invalidated).
+     * The world_H_base transform depends only on these joints.
+     */
+    bool kinematicsChanged();
+
+    /**
+     * Invalidate the kinematics cache, to be called when the estimator is reset
+     * or its fixed link changes.
+     */
+    void invalidateKinematicsCache();
+
+    /**
+     * Compute the DOFs in the chain from the current fixed link to the base link.
+     */
+    void computeFixedLinkToBaseDOFs();
+
+    /**
+     * Transform world_H_base, computed at most once for each kinematics update
+     * and shared by all the publishers.
+     */
+    const iDynTree::Transform & getWorldBaseTransform();
+
     // Publish related methods
     void publishEstimatedQuantities();
     void publishFloatingBasePosInWBIFormat();
@@ -169,6 +195,26 @@ private:
     /// < Joint velocities (for now set to zero)
     iDynTree::JointDOFsDoubleArray jointVelSetToZero;
 
+    /**
+     * Kinematics cache
+     */
+
+    /// < Joint position used in the last kinematics update
+    iDynTree::JointPosDoubleArray  cachedJointPos;
+
+    /// < DOFs in the chain from the current fixed link to the base link
+    std::vector<size_t> fixedLinkToBaseDOFs;
+
+    /// < True if cachedJointPos and fixedLinkToBaseDOFs are consistent with the estimator
+    bool kinematicsCacheValid;
+
+    /// < world_H_base for the last kinematics update, valid if worldBaseTransformValid is true
+    iDynTree::Transform cachedWorld_H_base;
+    bool worldBaseTransformValid;
+
+    /// < Threshold (in radians) on the joint motion that triggers a kinematics update
+    double kinematicsCacheThreshold;
+
     /**
      * RPC Calibration related attributes
      */
@@ -30,7 +30,11 @@ inline void GSInputPortProcessor::resetStat()
     prev=now;
 }
 
-GSInputPortProcessor::GSInputPortProcessor()
+GSInputPortProcessor::GSInputPortProcessor(): writeIndex(0),
+                                              middleIndex(1),
+                                              readIndex(2),
+                                              newSampleAvailable(false),
+                                              channels(0)
 {
     resetStat();
 }
@@ -39,59 +43,82 @@ void GSInputPortProcessor::onRead(yarp::sig::Vector &v)
 {
     now=Time::now();
 
-    yarp::os::LockGuard guard(mutex);
+    // The buffer at writeIndex is used only by the port callback
+    buffers[writeIndex].vector=v;
 
-    if (count>0)
     {
-        double tmpDT=now-prev;
-
-        deltaT+=tmpDT;
-
-        if (tmpDT>deltaTMax)
-        {
-            deltaTMax=tmpDT;
-        }
+        yarp::os::LockGuard guard(mutex);
 
-        if (tmpDT<deltaTMin)
+        if (count>0)
         {
-            deltaTMin=tmpDT;
+            double tmpDT=now-prev;
+
+            deltaT+=tmpDT;
+
+            if (tmpDT>deltaTMax)
+            {
+                deltaTMax=tmpDT;
+            }
+
+            if (tmpDT<deltaTMin)
+            {
+                deltaTMin=tmpDT;
+            }
+
+            //compare network time
+            if (tmpDT*1000<GS_ANALOG_TIMEOUT)
+            {
+                dataAvailable=true;
+            }
+            else
+            {
+                dataAvailable=false;
+            }
         }
 
-        //compare network time
-        if (tmpDT*1000<GS_ANALOG_TIMEOUT)
+        if( count == 0 )
         {
-            dataAvailable=true;
+            dataAvailable = true;
         }
-        else
-        {
-            dataAvailable=false;
-        }
-    }
-
-    if( count == 0 )
-    {
-        dataAvailable = true;
-    }
 
-    prev=now;
-    count++;
+        prev=now;
+        count++;
 
-    lastVector=v;
-    lastStamp.update();
+        lastStamp.update();
+        buffers[writeIndex].stamp=lastStamp;
+        channels=(int)v.size();
 
+        // Make the sample available to the readers
+        int buf=middleIndex;
+        middleIndex=writeIndex;
+        writeIndex=buf;
+        newSampleAvailable=true;
+    }
 }
 
 inline bool GSInputPortProcessor::getLast(yarp::sig::Vector &data, Stamp &stmp)
 {
-    yarp::os::LockGuard guard(mutex);
+    yarp::os::LockGuard readGuard(readMutex);
 
-    if (dataAvailable)
+    mutex.lock();
+    bool available=dataAvailable;
+    if (newSampleAvailable)
     {
-        data=lastVector;
-        stmp = lastStamp;
+        int buf=readIndex;
+        readIndex=middleIndex;
+        middleIndex=buf;
+        newSampleAvailable=false;
     }
+    mutex.unlock();
 
-    return dataAvailable;
+    // The buffer at readIndex is used only by the readers
+    if (available)
+    {
+        data=buffers[readIndex].vector;
+        stmp=buffers[readIndex].stamp;
+    }
+
+    return available;
 }
 
 inline int GSInputPortProcessor::getIterations()
@@ -128,7 +155,9 @@ bool GSInputPortProcessor::getState()
 
 int GSInputPortProcessor::getChannels()
 {
-    return (int)lastVector.size();
+    yarp::os::LockGuard guard(mutex);
+
+    return channels;
 }
 
 
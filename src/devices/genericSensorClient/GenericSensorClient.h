@@ -17,15 +17,39 @@
 #include <yarp/os/Time.h>
 #include <yarp/dev/PolyDriver.h>
 
+/**
+ * Sample received by a GSInputPortProcessor.
+ */
+struct GSSample
+{
+    yarp::sig::Vector vector;
+    yarp::os::Stamp stamp;
+};
+
 /**
  * Class copied from the InputPortProcessor class in AnalogSensorClient.
  * Once we port this in YARP we can merge this two classes.
+ *
+ * The latest sample is stored in a triple buffer: the port callback copies the sample
+ * in a buffer that is used only by itself, and then holds the mutex just to swap
+ * two indices. In the same way, the readers copy the sample from a buffer that is used only
+ * by them, so the readers and the port callback never wait for each other to copy a sample.
  */
 class GSInputPortProcessor : public yarp::os::BufferedPort<yarp::sig::Vector>
 {
+    // Protects the statistics and the indices of the triple buffer
     yarp::os::Mutex mutex;
-    yarp::sig::Vector lastVector;
+    GSSample buffers[3];
+    int writeIndex;
+    int middleIndex;
+    int readIndex;
+    bool newSampleAvailable;
     yarp::os::Stamp lastStamp;
+    int channels;
+
+    // Serializes the readers (the port callback never takes it)
+    yarp::os::Mutex readMutex;
+
     double deltaT;
     double deltaTMax;
     double deltaTMin;
@@ -23,9 +23,63 @@
 using namespace std;
 using namespace yarp::os;
 
+void JointTorqueLoopParameters::resize(int NDOF)
+{
+    kp.setZero(NDOF);
+    ki.setZero(NDOF);
+    max_int.setZero(NDOF);
+    max_pwm.setZero(NDOF);
+    kff.setZero(NDOF);
+    kv.setZero(NDOF);
+    kcp.setZero(NDOF);
+    kcn.setZero(NDOF);
+    coulombVelThr.setZero(NDOF);
+    frictionCompensation.setZero(NDOF);
+}
+
+void JointTorqueLoopParameters::update(const std::vector<JointTorqueLoopGains> & gains,
+                                       const std::vector<MotorParameters> & motorParams)
+{
+    for(size_t j=0; j < gains.size(); j++)
+    {
+        kp[j]                   = gains[j].kp;
+        ki[j]                   = gains[j].ki;
+        max_int[j]              = gains[j].max_int;
+        max_pwm[j]              = gains[j].max_pwm;
+        kff[j]                  = motorParams[j].kff;
+        kv[j]                   = motorParams[j].kv;
+        kcp[j]                  = motorParams[j].kcp;
+        kcn[j]                  = motorParams[j].kcn;
+        coulombVelThr[j]        = motorParams[j].coulombVelThr;
+        frictionCompensation[j] = motorParams[j].frictionCompensation;
+    }
+}
+
+void SparseCouplingMatrix::init(const Eigen::MatrixXd & denseMatrix)
+{
+    isIdentity = (denseMatrix == Eigen::MatrixXd::Identity(denseMatrix.rows(),denseMatrix.cols()));
+    matrix = denseMatrix.sparseView();
+    matrix.makeCompressed();
+}
+
+void SparseCouplingMatrix::apply(const Eigen::Map<Eigen::VectorXd> & in, Eigen::Map<Eigen::VectorXd> out) const
+{
+    if( isIdentity )
+    {
+        out = in;
+    }
+    else
+    {
+        out.noalias() = matrix*in;
+    }
+}
+
 namespace yarp {
 namespace dev {
 
+/** Period (in seconds) of the report of the dropped, stale and late reference torques in streaming mode. */
+const double jointTorqueControl_refTorquesReportPeriodInSeconds = 5.0;
+
 template <class T>
 bool contains(std::vector<T>  &v, T  &x)
 {
@@ -74,6 +128,14 @@ bool JointTorqueControl::isHijackingTorqueControl(int j)
 JointTorqueControl::JointTorqueControl():
                     PassThroughControlBoard(), RateThread(10)
 {
+    refTorquesMonitor.lastSequenceNumber = -1;
+    refTorquesMonitor.lastReceptionTime = 0.0;
+    refTorquesMonitor.timeoutInSeconds = 0.0;
+    refTorquesMonitor.stale = true;
+    refTorquesMonitor.nrOfDropped = 0;
+    refTorquesMonitor.nrOfStaleEvents = 0;
+    refTorquesMonitor.maxLatency = 0.0;
+    refTorquesMonitor.lastReportTime = 0.0;
 }
 
 JointTorqueControl::~JointTorqueControl()
@@ -148,6 +210,8 @@ bool JointTorqueControl::loadGains(yarp::os::Searchable& config)
 
     }
 
+    jointTorqueLoopParameters.update(jointTorqueLoopGains,motorParameters);
+
     return true;
 
 }
@@ -286,6 +350,8 @@ bool JointTorqueControl::open(yarp::os::Searchable& config)
     integralJointTorquesError.resize(axes,0.0);
     integralState.resize(axes,0.0);
     jointControlOutputBuffer.resize(axes,0.0);
+    coulombFriction.resize(axes,0.0);
+    jointTorqueLoopParameters.resize(axes);
 
     //Start control thread
     this->setRate(config.check("controlPeriod",10,"update period of the torque control thread (ms)").asInt());
@@ -314,6 +380,10 @@ bool JointTorqueControl::open(yarp::os::Searchable& config)
     std::cerr << "fromMotorTorquesToJointTorques matrix firmware" << std::endl;
     std::cerr << couplingMatricesFirmware.fromMotorTorquesToJointTorques << std::endl;
 
+    fromJointTorquesToMotorTorquesCoupling.init(couplingMatrices.fromJointTorquesToMotorTorques);
+    fromJointVelocitiesToMotorVelocitiesCoupling.init(couplingMatrices.fromJointVelocitiesToMotorVelocities);
+    fromMotorTorquesToJointTorquesFirmwareCoupling.init(couplingMatricesFirmware.fromMotorTorquesToJointTorques);
+
 
     streamingOutput = config.check("streamingOutput");
     std::cerr << "streamingOutput = " << streamingOutput << std::endl;
@@ -325,6 +395,9 @@ bool JointTorqueControl::open(yarp::os::Searchable& config)
         partName = config.find("name").asString();
         portForStreamingPWM.open(partName + "/output_pwms");
         portForReadingRefTorques.open(partName +"/input_torques");
+
+        refTorquesMonitor.timeoutInSeconds = config.check("refTorquesTimeout",0.1,"time (s) after which the streamed reference torques are considered stale").asDouble();
+        refTorquesMonitor.lastReportTime = yarp::os::Time::now();
     }
 
 
@@ -648,6 +721,7 @@ bool JointTorqueControl::setBemfParam(int j, double bemf)
 {
     yarp::os::LockGuard(this->globalMutex);
     motorParameters[j].kv = bemf;
+    jointTorqueLoopParameters.update(jointTorqueLoopGains,motorParameters);
     return true;
 }
 
@@ -667,6 +741,8 @@ bool JointTorqueControl::setTorquePid(int j, const Pid &pid)
     motorParameters[j].kcn = pid.stiction_down_val;
     motorParameters[j].kff = pid.kff;
 
+    jointTorqueLoopParameters.update(jointTorqueLoopGains,motorParameters);
+
     return true;
 }
 
@@ -821,63 +897,63 @@ inline Eigen::Map<Eigen::VectorXd> toEigenVector(yarp::sig::Vector & vec)
     return Eigen::Map<Eigen::VectorXd>(vec.data(), vec.size());
 }
 
+/** Saturate each element of x between -bound and bound (element-wise version of saturation). */
+inline void saturationInPlace(Eigen::Map<Eigen::VectorXd> x, const Eigen::VectorXd & bound)
+{
+    x = (x.array() > bound.array()).select(bound.array(),
+                                           (x.array() < -bound.array()).select(-bound.array(),x.array()));
+}
+
 void JointTorqueControl::computeOutputMotorTorques()
 {
     //Compute joint level torque PID
     double dt = this->getRate() * 0.001;
 
-    for(int j=0; j < this->axes; j++ )
-    {
-        JointTorqueLoopGains &gains = jointTorqueLoopGains[j];
-        jointTorquesError[j]        = measuredJointTorques[j] - desiredJointTorques[j];
-        integralState[j]            = saturation(integralState[j] + gains.ki*dt*jointTorquesError(j),gains.max_int,-gains.max_int );
-        jointControlOutputBuffer[j] = desiredJointTorques[j] - gains.kp*jointTorquesError[j] - integralState[j];
-    }
-
-    toEigenVector(jointControlOutput) = couplingMatrices.fromJointTorquesToMotorTorques * toEigenVector(jointControlOutputBuffer);
-    toEigenVector(measuredMotorVelocities) = couplingMatrices.fromJointVelocitiesToMotorVelocities * toEigenVector(measuredJointVelocities);
-
-    // Evaluation of coulomb friction with smoothing close to zero velocity
-    double coulombFriction;
-    double coulombVelThre;
-    for (int j = 0; j < this->axes; j++)
-    {
-        MotorParameters motorParam = motorParameters[j];
-        coulombVelThre =  motorParam.coulombVelThr;
-        //viscous friction compensation
-        if (fabs(measuredMotorVelocities[j]) >= coulombVelThre)
-        {
-            coulombFriction = sign(measuredMotorVelocities[j]);
-        }
-        else
-        {
-            coulombFriction = pow(measuredMotorVelocities[j] / coulombVelThre, 3);
-        }
-        if (measuredMotorVelocities[j] > 0 )
-        {
-            coulombFriction = motorParam.kcp*coulombFriction;
-        }
-        else
-        {
-            coulombFriction = motorParam.kcn*coulombFriction;
-        }
-        jointControlOutput[j] = motorParam.kff*jointControlOutput[j] + motorParameters[j].frictionCompensation * (motorParam.kv*measuredMotorVelocities[j] + coulombFriction);
-    }
+    // The loop is evaluated on all the joints at once: all the expressions
+    // are evaluated element-wise, without dynamic memory allocation
+    const JointTorqueLoopParameters & params = jointTorqueLoopParameters;
+    Eigen::Map<Eigen::VectorXd> error(jointTorquesError.data(),jointTorquesError.size());
+    Eigen::Map<Eigen::VectorXd> integral(integralState.data(),integralState.size());
+    Eigen::Map<Eigen::VectorXd> output(jointControlOutput.data(),jointControlOutput.size());
+    Eigen::Map<Eigen::VectorXd> outputBuffer(jointControlOutputBuffer.data(),jointControlOutputBuffer.size());
+    Eigen::Map<Eigen::VectorXd> motorVel(measuredMotorVelocities.data(),measuredMotorVelocities.size());
+    Eigen::Map<Eigen::VectorXd> coulomb(coulombFriction.data(),coulombFriction.size());
+
+    error = toEigenVector(measuredJointTorques) - toEigenVector(desiredJointTorques);
+    integral.array() += params.ki.array()*dt*error.array();
+    saturationInPlace(integral,params.max_int);
+    outputBuffer.array() = toEigenVector(desiredJointTorques).array() - params.kp.array()*error.array() - integral.array();
+
+    fromJointTorquesToMotorTorquesCoupling.apply(outputBuffer,output);
+    fromJointVelocitiesToMotorVelocitiesCoupling.apply(toEigenVector(measuredJointVelocities),motorVel);
+
+    // Evaluation of coulomb friction with smoothing close to zero velocity:
+    // sign(vel) if |vel| >= coulombVelThr, (vel/coulombVelThr)^3 otherwise
+    coulomb.array() = (motorVel.array().abs() >= params.coulombVelThr.array()).select(motorVel.array().sign(),
+                                                                                      (motorVel.array()/params.coulombVelThr.array()).cube());
+    coulomb.array() = (motorVel.array() > 0.0).select(params.kcp.array()*coulomb.array(),
+                                                      params.kcn.array()*coulomb.array());
+
+    //viscous friction compensation
+    output.array() = params.kff.array()*output.array()
+                     + params.frictionCompensation.array()*(params.kv.array()*motorVel.array() + coulomb.array());
 
     if (streamingOutput)
     {
-        yarp::sig::Vector& output = portForStreamingPWM.prepare();
-        output = jointControlOutput;
+        yarp::sig::Vector& streamedOutput = portForStreamingPWM.prepare();
+        streamedOutput = jointControlOutput;
+        refTorquesMonitor.outputStamp.update();
+        portForStreamingPWM.setEnvelope(refTorquesMonitor.outputStamp);
         portForStreamingPWM.write();
     }
 
-    toEigenVector(jointControlOutput) = couplingMatricesFirmware.fromMotorTorquesToJointTorques * toEigenVector(jointControlOutput);
+    fromMotorTorquesToJointTorquesFirmwareCoupling.apply(output,outputBuffer);
+    saturationInPlace(outputBuffer,params.max_pwm);
+    output = outputBuffer;
 
     bool isNaNOrInf = false;
     for(int j = 0; j < this->axes; j++)
     {
-
-        jointControlOutput[j] = saturation(jointControlOutput[j], jointTorqueLoopGains[j].max_pwm, -jointTorqueLoopGains[j].max_pwm);
         if (isnan(jointControlOutput[j]) || isinf(jointControlOutput[j])) { //this is not std c++. Supported in C99 and C++11
             jointControlOutput[j] = 0;
             isNaNOrInf = true;
@@ -889,6 +965,60 @@ void JointTorqueControl::computeOutputMotorTorques()
 
 }
 
+void JointTorqueControl::readReferenceTorques()
+{
+    double now = yarp::os::Time::now();
+
+    // The reference torques are read as a binary vector, without parsing a Bottle
+    // (a Bottle containing only doubles sent by an old client is read correctly as well)
+    yarp::sig::Vector * refTorques = portForReadingRefTorques.read(false);
+    if( refTorques != 0 )
+    {
+        size_t nrOfTorques = std::min(refTorques->size(),desiredJointTorques.size());
+        memcpy(desiredJointTorques.data(),refTorques->data(),nrOfTorques*sizeof(double));
+
+        if( portForReadingRefTorques.getEnvelope(refTorquesMonitor.stamp) && refTorquesMonitor.stamp.isValid() )
+        {
+            int sequenceNumber = refTorquesMonitor.stamp.getCount();
+            if( refTorquesMonitor.lastSequenceNumber >= 0 && sequenceNumber > refTorquesMonitor.lastSequenceNumber+1 )
+            {
+                refTorquesMonitor.nrOfDropped += sequenceNumber-refTorquesMonitor.lastSequenceNumber-1;
+            }
+            refTorquesMonitor.lastSequenceNumber = sequenceNumber;
+            refTorquesMonitor.maxLatency = std::max(refTorquesMonitor.maxLatency,now-refTorquesMonitor.stamp.getTime());
+        }
+
+        if( refTorquesMonitor.stale )
+        {
+            yInfo("JointTorqueControl: receiving reference torques on %s",portForReadingRefTorques.getName().c_str());
+        }
+        refTorquesMonitor.lastReceptionTime = now;
+        refTorquesMonitor.stale = false;
+    }
+    else if( !refTorquesMonitor.stale &&
+             now-refTorquesMonitor.lastReceptionTime > refTorquesMonitor.timeoutInSeconds )
+    {
+        // Keep using the last reference, but let the user know
+        refTorquesMonitor.stale = true;
+        refTorquesMonitor.nrOfStaleEvents++;
+        yWarning("JointTorqueControl: no reference torques received in the last %lf seconds, using the last received reference",
+                 refTorquesMonitor.timeoutInSeconds);
+    }
+
+    if( now-refTorquesMonitor.lastReportTime > jointTorqueControl_refTorquesReportPeriodInSeconds )
+    {
+        if( refTorquesMonitor.nrOfDropped > 0 || refTorquesMonitor.nrOfStaleEvents > 0 )
+        {
+            yWarning("JointTorqueControl: in the last %lf seconds %lu reference torques were dropped, the reference was stale %lu times, max latency %lf seconds",
+                     now-refTorquesMonitor.lastReportTime,refTorquesMonitor.nrOfDropped,refTorquesMonitor.nrOfStaleEvents,refTorquesMonitor.maxLatency);
+        }
+        refTorquesMonitor.nrOfDropped = 0;
+        refTorquesMonitor.nrOfStaleEvents = 0;
+        refTorquesMonitor.maxLatency = 0.0;
+        refTorquesMonitor.lastReportTime = now;
+    }
+}
+
 void JointTorqueControl::run()
 {
     // The control mutex protect concurrent access also to the
@@ -911,14 +1041,7 @@ void JointTorqueControl::run()
     // if in streamingOutput mode read the reference torques from a port
     if( streamingOutput )
     {
-        yarp::os::Bottle * ref_torques = portForReadingRefTorques.read(false);
-        if( ref_torques != 0 )
-        {
-            for(int i = 0; i < ref_torques->size() && i < desiredJointTorques.size(); i++ )
-            {
-                desiredJointTorques[i] = (*ref_torques).get(i).asDouble();
-            }
-        }
+        this->readReferenceTorques();
     }
 
     //update output torques
@@ -11,11 +11,13 @@
 
 #include <yarp/os/Mutex.h>
 #include <yarp/os/RateThread.h>
+#include <yarp/os/Stamp.h>
 
 #include <yarp/sig/Vector.h>
 
 #include "PassThroughControlBoard.h"
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 #include <vector>
 
 namespace yarp {
@@ -134,6 +136,51 @@ struct JointTorqueLoopGains
     }
 };
 
+/**
+ * Gains and motor parameters of all the joints, stored as one vector for each
+ * parameter so that the torque loop is evaluated on all the joints at once.
+ *
+ * It is a copy of the JointTorqueLoopGains and MotorParameters vectors, updated
+ * every time they are modified.
+ */
+struct JointTorqueLoopParameters
+{
+    Eigen::VectorXd kp;
+    Eigen::VectorXd ki;
+    Eigen::VectorXd max_int;
+    Eigen::VectorXd max_pwm;
+    Eigen::VectorXd kff;
+    Eigen::VectorXd kv;
+    Eigen::VectorXd kcp;
+    Eigen::VectorXd kcn;
+    Eigen::VectorXd coulombVelThr;
+    Eigen::VectorXd frictionCompensation;
+
+    void resize(int NDOF);
+
+    void update(const std::vector<JointTorqueLoopGains> & gains,
+                const std::vector<MotorParameters> & motorParams);
+};
+
+/**
+ * Coupling matrix in the form that is cheaper to apply at each control cycle:
+ * nothing if it is the identity, a sparse matrix otherwise (the couplings are block diagonal
+ * and most of the joints are not coupled).
+ */
+struct SparseCouplingMatrix
+{
+    bool isIdentity;
+    Eigen::SparseMatrix<double,Eigen::RowMajor> matrix;
+
+    void init(const Eigen::MatrixXd & denseMatrix);
+
+    /**
+     * Compute out = matrix*in, without dynamic memory allocation.
+     * @note in and out should not be aliased.
+     */
+    void apply(const Eigen::Map<Eigen::VectorXd> & in, Eigen::Map<Eigen::VectorXd> out) const;
+};
+
 class yarp::dev::JointTorqueControl :  public yarp::dev::PassThroughControlBoard,
                                        public yarp::os::RateThread
 {
@@ -152,7 +199,29 @@ private:
     bool streamingOutput;
     std::string partName;
     yarp::os::BufferedPort<yarp::sig::Vector> portForStreamingPWM;
-    yarp::os::BufferedPort<yarp::os::Bottle> portForReadingRefTorques;
+    yarp::os::BufferedPort<yarp::sig::Vector> portForReadingRefTorques;
+
+    /**
+     * Monitoring of the reference torques received in streaming mode.
+     * The sender is expected to set an envelope (yarp::os::Stamp) on its port:
+     * the sequence number is used to count the dropped references, the timestamp
+     * to compute their latency.
+     */
+    struct
+    {
+        yarp::os::Stamp stamp;                ///< envelope of the last received reference
+        yarp::os::Stamp outputStamp;          ///< envelope of the streamed PWMs
+        int lastSequenceNumber;               ///< -1 if no reference with a valid envelope was received
+        double lastReceptionTime;             ///< time at which the last reference was received
+        double timeoutInSeconds;              ///< a reference older than this is considered stale
+        bool stale;                           ///< true if the last reference is stale
+        unsigned long nrOfDropped;            ///< references dropped since the last report
+        unsigned long nrOfStaleEvents;        ///< times the reference became stale since the last report
+        double maxLatency;                    ///< max latency since the last report
+        double lastReportTime;
+    } refTorquesMonitor;
+
+    void readReferenceTorques();
 
 
     void startHijackingTorqueControlIfNecessary(int j);
@@ -164,11 +233,17 @@ private:
     CouplingMatrices couplingMatrices;
     CouplingMatrices couplingMatricesFirmware;
 
+    // Coupling matrices actually used in the control loop
+    SparseCouplingMatrix fromJointTorquesToMotorTorquesCoupling;
+    SparseCouplingMatrix fromJointVelocitiesToMotorVelocitiesCoupling;
+    SparseCouplingMatrix fromMotorTorquesToJointTorquesFirmwareCoupling;
+
     //joint torque loop methods & attributes
     yarp::os::Mutex globalMutex; ///< mutex protecting control variables & proxy interface methods
 
     std::vector<JointTorqueLoopGains>                jointTorqueLoopGains;
     std::vector<MotorParameters> 		             motorParameters;
+    JointTorqueLoopParameters                        jointTorqueLoopParameters;
     yarp::sig::Vector                                desiredJointTorques;
     yarp::sig::Vector                                measuredJointTorques;
     yarp::sig::Vector                                measuredJointPositionsTimestamps;
@@ -182,6 +257,7 @@ private:
     yarp::sig::Vector                                integralState;
     yarp::sig::Vector                                jointControlOutput;
     yarp::sig::Vector                                jointControlOutputBuffer;
+    yarp::sig::Vector                                coulombFriction;
 
     void readStatus();
 
@@ -174,6 +174,7 @@ bool VirtualAnalogClient::updateMeasure(int ch, double& measure)
     if( ch < 0 || ch >= this->getChannels() )
     {
         yError() << "VirtualAnalogClient: updateMeasure failed : requested channel " << ch << " while the client is configured with " << this->getChannels() << " channels";
+        return false;
     }
 
     measureBuffer[ch] = measure;
@@ -14,7 +14,7 @@ using namespace yarp::dev;
 using namespace yarp::os;
 using namespace yarp::sig;
 
-VirtualAnalogRemapper::VirtualAnalogRemapper()
+VirtualAnalogRemapper::VirtualAnalogRemapper(): m_coalesceUpdates(false)
 {
 
 }
@@ -43,6 +43,18 @@ bool VirtualAnalogRemapper::open(Searchable& config)
         m_axesNames[jnt] = axesNamesBot->get(jnt).asString();
     }
 
+    m_coalesceUpdates = false;
+    if( prop.check("coalesceUpdates") )
+    {
+        if( !prop.find("coalesceUpdates").isBool() )
+        {
+            yError("VirtualAnalogRemapper: coalesceUpdates parameter found, but it is not a bool");
+            return false;
+        }
+
+        m_coalesceUpdates = prop.find("coalesceUpdates").asBool();
+    }
+
     // Waiting for attach now
     return true;
 }
@@ -112,7 +124,8 @@ bool VirtualAnalogRemapper::attachAll(const PolyDriverList& p)
             remappedAxes[axis].dev = 0;
             remappedAxes[axis].devInfo = 0;
             remappedAxes[axis].localAxis = 0;
-
+            remappedAxes[axis].devIdx = -1;
+            remappedAxes[axis].useVectorUpdateMeasure = false;
 
             // we support not publishing the information for some axis
             // (as most of the time we estimates torques for axis that don't have a virtual analog sensor)
@@ -122,6 +135,7 @@ bool VirtualAnalogRemapper::attachAll(const PolyDriverList& p)
             remappedAxes[axis].dev = axisName2virtualAnalogSensorPtr[jointName];
             remappedAxes[axis].devInfo = axisName2IAxisInfoPtr[jointName];
             remappedAxes[axis].localAxis = axisName2localAxis[jointName];
+            remappedAxes[axis].useVectorUpdateMeasure = false;
         }
     }
 
@@ -154,13 +168,20 @@ bool VirtualAnalogRemapper::attachAll(const PolyDriverList& p)
         }
 
         // If all the axes of the subdevice are remapped, we can use the vector updateMeasure
-        if( axesOfSubDeviceThatAreRemapped == remappedSubdevices[subdev].dev->getChannels() )
+        // (if the updates are coalesced, it is sufficient that one axis of the subdevice is remapped)
+        bool allAxesRemapped = (axesOfSubDeviceThatAreRemapped == remappedSubdevices[subdev].dev->getChannels());
+        bool someAxesRemapped = (axesOfSubDeviceThatAreRemapped > 0);
+        if( allAxesRemapped || (m_coalesceUpdates && someAxesRemapped) )
         {
             remappedSubdevices[subdev].useVectorUpdateMeasure = true;
             for(size_t localIndex = 0; localIndex < remappedSubdevices[subdev].local2globalIdx.size(); localIndex++)
             {
                 int globalIdx = remappedSubdevices[subdev].local2globalIdx[localIndex];
-                remappedAxes[globalIdx].useVectorUpdateMeasure = true;
+
+                if( globalIdx >= 0 )
+                {
+                    remappedAxes[globalIdx].useVectorUpdateMeasure = true;
+                }
             }
         }
         else
@@ -170,7 +191,7 @@ bool VirtualAnalogRemapper::attachAll(const PolyDriverList& p)
             {
                 int globalIdx = remappedSubdevices[subdev].local2globalIdx[localIndex];
 
-                if( globalIdx > 0 )
+                if( globalIdx >= 0 )
                 {
                     remappedAxes[globalIdx].useVectorUpdateMeasure = false;
                 }
@@ -215,11 +236,15 @@ bool VirtualAnalogRemapper::updateMeasure(Vector& measure)
         {
             IVirtualAnalogSensor * dev = this->remappedSubdevices[subdevIdx].dev;
 
-            // Update the measure buffer
+            // Update the measure buffer (the channels that are not remapped are left to zero, overwriting their value on the subdevice)
             for(size_t localIndex = 0; localIndex < this->remappedSubdevices[subdevIdx].measureBuffer.size(); localIndex++)
             {
                 int globalIndex = this->remappedSubdevices[subdevIdx].local2globalIdx[localIndex];
-                this->remappedSubdevices[subdevIdx].measureBuffer[localIndex] = measure[globalIndex];
+
+                if( globalIndex >= 0 )
+                {
+                    this->remappedSubdevices[subdevIdx].measureBuffer[localIndex] = measure[globalIndex];
+                }
             }
 
             bool ok = dev->updateMeasure(this->remappedSubdevices[subdevIdx].measureBuffer);
@@ -251,6 +276,7 @@ bool VirtualAnalogRemapper::updateMeasure(int ch, double& measure)
     if( ch < 0 || ch >= this->getChannels() )
     {
         yError() << "VirtualAnalogRemapper: updateMeasure failed : requested channel " << ch << " while the client is configured with " << this->getChannels() << " channels";
+        return false;
     }
 
     // In this case we need to use the single axis method
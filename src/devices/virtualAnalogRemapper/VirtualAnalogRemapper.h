@@ -63,11 +63,17 @@ struct virtualAnalogSensorRemappedSubdevice
 *  Consequently if the VirtualAnalogRemapper detects that all channels in a subdevice are part
 *  of the remapped device, the vector-value updateMeasure method will be used.
 *
+*  If coalesceUpdates is true, the vector-value updateMeasure method is used also for the subdevices
+*  of which only some channels are remapped, so that each subdevice is updated with a single call
+*  to its updateMeasure. IVirtualAnalogSensor has no partial update, so there is no mask: the channels of the
+*  subdevice that are not remapped are overwritten with zero at every update.
+*
 *
 *  Parameters required by this device are:
 * | Parameter name | SubParameter   | Type    | Units          | Default Value | Required                    | Description                                                       | Notes |
 * |:--------------:|:--------------:|:-------:|:--------------:|:-------------:|:--------------------------: |:-----------------------------------------------------------------:|:-----:|
 * | axesNames     |      -          | vector of strings  | -   |   -           | Yes     | Ordered list of the axes that are part of the remapped device. |  |
+* | coalesceUpdates |    -          | bool               | -   | false         | No      | Use the vector-value updateMeasure also for partially remapped subdevices. | The not remapped channels are overwritten with zero: do not use it if they are updated by someone else. |
 *
 * The axes are then mapped to the wrapped controlboard in the attachAll method, using the
 * values returned by the getAxisName method of the attached devices.
@@ -90,6 +96,11 @@ protected:
 
     std::vector<std::string> m_axesNames;
 
+    /**
+     * If true, also the subdevices with some channels not remapped are updated with the vector-value updateMeasure.
+     */
+    bool m_coalesceUpdates;
+
     /**
      * Vector containg the information about a specific axis remapped by this device.
      * This is configured during the attachAll method.
@@ -6,6 +6,10 @@
 #include <iDynTree/Core/ClassicalAcc.h>
 
 #include <iDynTree/Estimation/ExternalWrenchesEstimation.h>
+#include <iDynTree/KinDynComputations.h>
+
+#include <yarp/os/Log.h>
+#include <yarp/os/LogStream.h>
 
 using namespace iDynTree;
 
@@ -176,6 +180,68 @@ bool GravityCompensationHelper::updateKinematicsFromProperAcceleration(const Joi
     }
 }
 
+bool GravityCompensationHelper::updateKinematicsFromGravity(KinDynComputations& kinDynComp,
+                                                            const JointPosDoubleArray& jointPos,
+                                                            const FrameIndex& fixedFrame,
+                                                            const Vector3& gravity)
+{
+    Vector3 properClassicalAcceleration;
+
+    properClassicalAcceleration(0) = -gravity(0);
+    properClassicalAcceleration(1) = -gravity(1);
+    properClassicalAcceleration(2) = -gravity(2);
+
+    return updateKinematicsFromProperAcceleration(kinDynComp,jointPos,fixedFrame,properClassicalAcceleration);
+}
+
+bool GravityCompensationHelper::updateKinematicsFromProperAcceleration(KinDynComputations& kinDynComp,
+                                                                       const JointPosDoubleArray& jointPos,
+                                                                       const FrameIndex& floatingFrame,
+                                                                       const Vector3& properClassicalLinearAcceleration)
+{
+    if( !m_isModelValid )
+    {
+        reportError("GravityCompensationHelper","updateKinematicsFromProperAcceleration","Model information not setted.");
+        return false;
+    }
+
+    if( floatingFrame == FRAME_INVALID_INDEX ||
+        floatingFrame < 0 || floatingFrame >= m_model.getNrOfFrames() )
+    {
+        reportError("GravityCompensationHelper","updateKinematicsFromProperAcceleration","Unknown frame index specified.");
+        return false;
+    }
+
+    if( kinDynComp.getNrOfLinks() != m_model.getNrOfLinks() )
+    {
+        reportError("GravityCompensationHelper","updateKinematicsFromProperAcceleration","KinDynComputations loaded with a different model.");
+        return false;
+    }
+
+    // With zero joint velocities and accelerations all the links have zero velocity, and
+    // the same proper acceleration of the floating frame (that has zero angular acceleration),
+    // just expressed in their own frame
+    Vector3 zero3;
+    zero3.zero();
+
+    SpatialAcc frame_acc;
+    frame_acc.setLinearVec3(properClassicalLinearAcceleration);
+    frame_acc.setAngularVec3(zero3);
+
+    for(LinkIndex link=0; link < static_cast<LinkIndex>(m_model.getNrOfLinks()); link++)
+    {
+        // The frame index of the main frame of a link is the link index
+        m_linkVels(link).zero();
+        m_linkProperAccs(link) = kinDynComp.getRelativeTransform(link,floatingFrame)*frame_acc;
+    }
+
+    // Store joint positions
+    m_jointPos = jointPos;
+
+    m_isKinematicsUpdated = true;
+    return true;
+}
+
 bool GravityCompensationHelper::getGravityCompensationTorques(JointDOFsDoubleArray & jointTrqs)
 {
     if( !m_isModelValid )
@@ -213,8 +279,122 @@ bool GravityCompensationHelper::getGravityCompensationTorques(JointDOFsDoubleArr
     return true;
 }
 
+GravityCompensationOffsetsPublisher::GravityCompensationOffsetsPublisher(const int periodInMs): RateThread(periodInMs),
+                                                                                             m_ctrlmode(0),
+                                                                                             m_intmode(0),
+                                                                                             m_impctrl(0),
+                                                                                             m_modesRefreshDecimation(1),
+                                                                                             m_cyclesSinceLastModesRefresh(0)
+{
+}
 
+bool GravityCompensationOffsetsPublisher::configure(yarp::dev::IControlMode2* ctrlmode,
+                                                    yarp::dev::IInteractionMode* intmode,
+                                                    yarp::dev::IImpedanceControl* impctrl,
+                                                    const std::vector<size_t>& joints,
+                                                    const Model& model,
+                                                    const int modesRefreshDecimation)
+{
+    m_ctrlmode = ctrlmode;
+    m_intmode  = intmode;
+    m_impctrl  = impctrl;
+
+    m_joints.resize(joints.size());
+    for(size_t i=0; i < joints.size(); i++)
+    {
+        m_joints[i] = (int)joints[i];
+    }
+
+    // Until the modes are read, no offset is published
+    m_controlModes.assign(m_joints.size(),VOCAB_CM_UNKNOWN);
+    m_interactionModes.assign(m_joints.size(),VOCAB_IM_UNKNOWN);
+
+    m_modesRefreshDecimation = modesRefreshDecimation < 1 ? 1 : modesRefreshDecimation;
+    m_cyclesSinceLastModesRefresh = 0;
 
+    // Allocate the torques buffers, and clear the mailbox
+    m_torques.resize(model);
+    m_torques.zero();
+    m_torquesMailbox.publish(m_torques);
+    m_torquesMailbox.fetch(m_torques);
+
+    return refreshModes();
 }
 
+bool GravityCompensationOffsetsPublisher::refreshModes()
+{
+    if( m_joints.size() == 0 )
+    {
+        return true;
+    }
+
+    bool ok = m_ctrlmode->getControlModes((int)m_joints.size(),&(m_joints[0]),&(m_controlModes[0]));
+    ok = m_intmode->getInteractionModes((int)m_joints.size(),&(m_joints[0]),&(m_interactionModes[0])) && ok;
+
+    if( !ok )
+    {
+        yWarning() << "wholeBodyDynamics : error in reading the control and interaction modes of the gravity compensated joints";
+    }
+
+    return ok;
+}
+
+bool GravityCompensationOffsetsPublisher::isOffsetPublished(const size_t i) const
+{
+    switch(m_controlModes[i])
+    {
+        case VOCAB_CM_POSITION:
+        case VOCAB_CM_POSITION_DIRECT:
+        case VOCAB_CM_MIXED:
+        case VOCAB_CM_VELOCITY:
+            return (m_interactionModes[i] == VOCAB_IM_COMPLIANT);
+
+        // We don't do anything in torque mode, differently from the
+        // old gravity compensation : because otherwise we interfere
+        // with any torque control loop
+        default:
+            return false;
+    }
+}
 
+void GravityCompensationOffsetsPublisher::publishTorques(const JointDOFsDoubleArray& torques)
+{
+    // If the publisher thread is copying the previous torques in this moment, this torques are skipped
+    m_torquesMailbox.tryPublish(torques);
+}
+
+void GravityCompensationOffsetsPublisher::sendOffsets()
+{
+    for(size_t i=0; i < m_joints.size(); i++)
+    {
+        if( isOffsetPublished(i) )
+        {
+            m_impctrl->setImpedanceOffset(m_joints[i],m_torques(m_joints[i]));
+        }
+    }
+}
+
+void GravityCompensationOffsetsPublisher::resetOffsets()
+{
+    for(size_t i=0; i < m_joints.size(); i++)
+    {
+        m_impctrl->setImpedanceOffset(m_joints[i],0.0);
+    }
+}
+
+void GravityCompensationOffsetsPublisher::run()
+{
+    m_cyclesSinceLastModesRefresh++;
+    if( m_cyclesSinceLastModesRefresh >= m_modesRefreshDecimation )
+    {
+        m_cyclesSinceLastModesRefresh = 0;
+        refreshModes();
+    }
+
+    if( m_torquesMailbox.fetch(m_torques) )
+    {
+        sendOffsets();
+    }
+}
+
+}
@@ -1,11 +1,24 @@
 #ifndef GRAVITY_COMPENSATION_HELPERS_H
 #define GRAVITY_COMPENSATION_HELPERS_H
 
+// YARP includes
+#include <yarp/os/RateThread.h>
+#include <yarp/dev/ControlBoardInterfaces.h>
+
 // iDynTree includes
 #include <iDynTree/Model/FreeFloatingState.h>
 #include <iDynTree/Model/Model.h>
 #include <iDynTree/Model/Traversal.h>
 
+#include "RPCHandoffHelpers.h"
+
+#include <vector>
+
+namespace iDynTree
+{
+    class KinDynComputations;
+}
+
 
 namespace wholeBodyDynamics
 {
@@ -99,6 +112,38 @@ public:
                                      const iDynTree::FrameIndex & floatingFrame,
                                      const iDynTree::Vector3 & gravity);
 
+    /**
+     * Set the kinematic information necessary for the gravity torques estimation,
+     * reusing the link transforms already computed by a KinDynComputations object.
+     *
+     * As the gravity torques are computed with zero joint velocities and accelerations,
+     * the proper acceleration of each link is just the proper acceleration of the floating
+     * frame rotated in the link frame: no kinematic traversal of the model is performed.
+     *
+     * @param[in] kinDynComp KinDynComputations loaded with the same model passed to loadModel,
+     *                       whose robot state has already been set to jointPos.
+     * @param[in] jointPos the position of the joints of the model.
+     * @param[in] floatingFrame the index of the frame for which proper acceleration is provided.
+     * @param[in] properClassicalLinearAcceleration proper (actual acceleration-gravity) classical acceleration
+     *                                              of the origin of the specified frame,
+     *                                              expressed in the specified frame orientation.
+     * @return true if all went ok, false otherwise.
+     */
+    bool updateKinematicsFromProperAcceleration(iDynTree::KinDynComputations & kinDynComp,
+                                                const iDynTree::JointPosDoubleArray  & jointPos,
+                                                const iDynTree::FrameIndex & floatingFrame,
+                                                const iDynTree::Vector3 & properClassicalLinearAcceleration);
+
+    /**
+     * Version of updateKinematicsFromGravity reusing the link transforms of a KinDynComputations object.
+     *
+     * \note This is implemented as updateKinematicsFromProperAcceleration(kinDynComp,jointPos,floatingFrame,-gravity);
+     */
+    bool updateKinematicsFromGravity(iDynTree::KinDynComputations & kinDynComp,
+                                     const iDynTree::JointPosDoubleArray  & jointPos,
+                                     const iDynTree::FrameIndex & floatingFrame,
+                                     const iDynTree::Vector3 & gravity);
+
 
     /**
      * Get the gravity compensation torques.
@@ -107,6 +152,79 @@ public:
 
 };
 
+/**
+ * Class publishing the gravity compensation torques as impedance offsets.
+ *
+ * The offset of a joint is published only if the joint is in position, position direct,
+ * mixed or velocity control mode and in compliant interaction mode. The control and interaction
+ * modes of all the joints are read with a single multi-joint call, every modesRefreshDecimation
+ * cycles of the thread, and cached in the meanwhile.
+ *
+ * When the thread is running, the estimation thread just posts the latest torques with publishTorques(),
+ * without blocking: the (possibly remote) controlboard calls are all performed in this thread.
+ */
+class GravityCompensationOffsetsPublisher: public yarp::os::RateThread
+{
+private:
+    yarp::dev::IControlMode2     * m_ctrlmode;
+    yarp::dev::IInteractionMode  * m_intmode;
+    yarp::dev::IImpedanceControl * m_impctrl;
+
+    /**< DOFs for which the gravity compensation is published */
+    std::vector<int> m_joints;
+
+    /**< Cached modes, m_controlModes[i] is the control mode of the DOF m_joints[i] */
+    std::vector<int> m_controlModes;
+    std::vector<yarp::dev::InteractionModeEnum> m_interactionModes;
+
+    int m_modesRefreshDecimation;
+    int m_cyclesSinceLastModesRefresh;
+
+    LatestValueMailbox<iDynTree::JointDOFsDoubleArray> m_torquesMailbox;
+    iDynTree::JointDOFsDoubleArray m_torques;
+
+    bool isOffsetPublished(const size_t i) const;
+
+public:
+    GravityCompensationOffsetsPublisher(const int periodInMs);
+
+    /**
+     * Configure the interfaces and the DOFs, and read their modes.
+     * @note it shall be called when the thread is not running.
+     */
+    bool configure(yarp::dev::IControlMode2 * ctrlmode,
+                   yarp::dev::IInteractionMode * intmode,
+                   yarp::dev::IImpedanceControl * impctrl,
+                   const std::vector<size_t> & joints,
+                   const iDynTree::Model & model,
+                   const int modesRefreshDecimation);
+
+    /**
+     * Read the control and interaction modes of all the DOFs.
+     */
+    bool refreshModes();
+
+    /**
+     * Post the latest gravity compensation torques (of all the DOFs of the model),
+     * that will be sent at the next cycle of the thread. It never blocks.
+     */
+    void publishTorques(const iDynTree::JointDOFsDoubleArray & torques);
+
+    /**
+     * Send the latest torques as impedance offsets, according to the cached modes.
+     */
+    void sendOffsets();
+
+    /**
+     * Set to zero the impedance offsets of all the DOFs, regardless of their modes.
+     * @note it shall be called when the thread is not running.
+     */
+    void resetOffsets();
+
+    // RATE THREAD
+    virtual void run();
+};
+
 }
 
 #endif
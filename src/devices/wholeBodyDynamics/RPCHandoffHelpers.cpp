@@ -0,0 +1,29 @@
+#include "RPCHandoffHelpers.h"
+
+#include <yarp/os/LockGuard.h>
+
+namespace wholeBodyDynamics
+{
+
+SettingsEditorHandoff::SettingsEditorHandoff(wholeBodyDynamicsSettings& settings,
+                                             yarp::os::Mutex& settingsMutex,
+                                             LatestValueMailbox<wholeBodyDynamicsSettings>& mailbox): m_settings(settings),
+                                                                                                      m_settingsMutex(settingsMutex),
+                                                                                                      m_mailbox(mailbox),
+                                                                                                      m_editor(settings)
+{
+}
+
+bool SettingsEditorHandoff::read(yarp::os::ConnectionReader& connection)
+{
+    yarp::os::LockGuard guard(m_settingsMutex);
+
+    bool ok = m_editor.read(connection);
+
+    // Publish the settings also if the edit failed, as some field could have been modified anyway
+    m_mailbox.publish(m_settings);
+
+    return ok;
+}
+
+}
@@ -0,0 +1,191 @@
+#ifndef RPC_HANDOFF_HELPERS_H
+#define RPC_HANDOFF_HELPERS_H
+
+// YARP includes
+#include <yarp/os/Mutex.h>
+#include <yarp/os/PortReader.h>
+#include <yarp/os/ConnectionReader.h>
+
+#include <wholeBodyDynamicsSettings.h>
+
+namespace wholeBodyDynamics
+{
+
+/**
+ * Mailbox containing the latest value of type T published by
+ * one thread and fetched by another.
+ *
+ * Both sides can use the non-blocking variants (tryPublish and tryFetch)
+ * that simply give up if the other side is copying the value
+ * in that moment: they are meant to be used in the estimation thread,
+ * so that it never waits for the (non real time) RPC threads.
+ */
+template<typename T>
+class LatestValueMailbox
+{
+private:
+    T m_value;
+    bool m_newValueAvailable;
+    yarp::os::Mutex m_mutex;
+
+public:
+    LatestValueMailbox(): m_newValueAvailable(false) {}
+
+    /**
+     * Publish a new value, waiting for a concurrent fetch to finish.
+     */
+    void publish(const T & value)
+    {
+        m_mutex.lock();
+        m_value = value;
+        m_newValueAvailable = true;
+        m_mutex.unlock();
+    }
+
+    /**
+     * Publish a new value, if the mailbox is not in use.
+     * @return true if the value was published, false otherwise.
+     */
+    bool tryPublish(const T & value)
+    {
+        if( !m_mutex.tryLock() )
+        {
+            return false;
+        }
+
+        m_value = value;
+        m_newValueAvailable = true;
+        m_mutex.unlock();
+
+        return true;
+    }
+
+    /**
+     * Copy the latest published value in value, waiting for a concurrent publish to finish.
+     * @return true if the value was published after the last fetch, false otherwise.
+     */
+    bool fetch(T & value)
+    {
+        m_mutex.lock();
+        bool newValue = m_newValueAvailable;
+        value = m_value;
+        m_newValueAvailable = false;
+        m_mutex.unlock();
+
+        return newValue;
+    }
+
+    /**
+     * Copy the latest published value in value, if a new value is available and the mailbox is not in use.
+     * @return true if value was updated, false otherwise.
+     */
+    bool tryFetch(T & value)
+    {
+        if( !m_mutex.tryLock() )
+        {
+            return false;
+        }
+
+        bool newValue = m_newValueAvailable;
+        if( newValue )
+        {
+            value = m_value;
+            m_newValueAvailable = false;
+        }
+        m_mutex.unlock();
+
+        return newValue;
+    }
+};
+
+/**
+ * Bounded FIFO of commands, pushed by the RPC threads and drained by the estimation thread.
+ *
+ * The storage is preallocated, and the mutex is held only to copy the commands:
+ * the consumer uses tryPopAll, that never waits for a producer.
+ */
+template<typename Command, int Capacity>
+class CommandsQueue
+{
+private:
+    Command m_commands[Capacity];
+    int m_head;
+    int m_size;
+    yarp::os::Mutex m_mutex;
+
+public:
+    CommandsQueue(): m_head(0), m_size(0) {}
+
+    /**
+     * Push a command at the end of the queue.
+     * @return true if the command was pushed, false if the queue is full.
+     */
+    bool push(const Command & command)
+    {
+        m_mutex.lock();
+        if( m_size == Capacity )
+        {
+            m_mutex.unlock();
+            return false;
+        }
+
+        m_commands[(m_head+m_size)%Capacity] = command;
+        m_size++;
+        m_mutex.unlock();
+
+        return true;
+    }
+
+    /**
+     * Move all the queued commands in commands, in the order in which they were pushed.
+     * @return the number of commands moved, 0 also if a producer is pushing a command in this moment.
+     */
+    int tryPopAll(Command (&commands)[Capacity])
+    {
+        if( !m_mutex.tryLock() )
+        {
+            return 0;
+        }
+
+        int nrOfCommands = m_size;
+        for(int i=0; i < nrOfCommands; i++)
+        {
+            commands[i] = m_commands[(m_head+i)%Capacity];
+        }
+        m_head = (m_head+nrOfCommands)%Capacity;
+        m_size = 0;
+        m_mutex.unlock();
+
+        return nrOfCommands;
+    }
+};
+
+/**
+ * Reader for the settings port: it edits a copy of the settings
+ * that is never used by the estimation thread, and then publishes
+ * it on a LatestValueMailbox, from which the estimation thread fetches it.
+ */
+class SettingsEditorHandoff: public yarp::os::PortReader
+{
+private:
+    wholeBodyDynamicsSettings & m_settings;
+    yarp::os::Mutex & m_settingsMutex;
+    LatestValueMailbox<wholeBodyDynamicsSettings> & m_mailbox;
+    wholeBodyDynamicsSettings::Editor m_editor;
+
+public:
+    /**
+     * @param settings the settings to edit
+     * @param settingsMutex mutex protecting settings from the other threads that modify it
+     * @param mailbox mailbox in which the modified settings are published
+     */
+    SettingsEditorHandoff(wholeBodyDynamicsSettings & settings,
+                          yarp::os::Mutex & settingsMutex,
+                          LatestValueMailbox<wholeBodyDynamicsSettings> & mailbox);
+
+    virtual bool read(yarp::os::ConnectionReader& connection);
+};
+
+}
+
+#endif
@@ -0,0 +1,315 @@
+#include "SensorsAcquisitionHelpers.h"
+
+#include <yarp/os/LockGuard.h>
+#include <yarp/os/Log.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include <iDynTree/yarp/YARPConversions.h>
+
+#include <cmath>
+
+namespace wholeBodyDynamics
+{
+
+const size_t sensorsAcquisition_nrOfChannelsOfYARPFTSensor = 6;
+const size_t sensorsAcquisition_nrOfChannelsOfAYARPIMUSensor = 12;
+
+static inline double deg2rad(const double angleInDeg)
+{
+    return angleInDeg*M_PI/180.0;
+}
+
+static void convertFromDegreesToRadians(iDynTree::VectorDynSize & vector)
+{
+    for(size_t i=0; i < vector.size(); i++)
+    {
+        vector(i) = deg2rad(vector(i));
+    }
+}
+
+bool readFTSensor(yarp::dev::IAnalogSensor * ftSensor,
+                  yarp::sig::Vector & ftMeasurement,
+                  iDynTree::Wrench & wrench)
+{
+    bool ok = (ftSensor->read(ftMeasurement) == yarp::dev::IAnalogSensor::AS_OK);
+
+    if( ok )
+    {
+        // Format of F/T measurement in YARP/iDynTree is consistent: linear/angular
+        iDynTree::toiDynTree(ftMeasurement,wrench);
+    }
+
+    return ok;
+}
+
+bool readIMUSensor(yarp::dev::IGenericSensor * imu,
+                   yarp::sig::Vector & imuMeasurement,
+                   iDynTree::Vector3 & linProperAcc,
+                   iDynTree::Vector3 & angularVel)
+{
+    bool ok = imu->read(imuMeasurement);
+
+    if( ok )
+    {
+        // Check format of IMU in YARP http://wiki.icub.org/wiki/Inertial_Sensor
+        angularVel(0) = deg2rad(imuMeasurement[6]);
+        angularVel(1) = deg2rad(imuMeasurement[7]);
+        angularVel(2) = deg2rad(imuMeasurement[8]);
+
+        linProperAcc(0) = imuMeasurement[3];
+        linProperAcc(1) = imuMeasurement[4];
+        linProperAcc(2) = imuMeasurement[5];
+    }
+
+    return ok;
+}
+
+SensorsSnapshot::SensorsSnapshot(): timestamp(0.0),
+                                    sequenceNumber(0),
+                                    readCorrectly(false),
+                                    encodersReadCorrectly(false),
+                                    imuReadCorrectly(false)
+{
+    imuLinProperAcc.zero();
+    imuAngularVel.zero();
+}
+
+void SensorsSnapshot::resize(const iDynTree::Model& model, const iDynTree::SensorsList& sensors)
+{
+    jointPos.resize(model);
+    jointVel.resize(model);
+    jointAcc.resize(model);
+    ftMeasurements.resize(sensors);
+    ftReadCorrectly.assign(sensors.getNrOfSensors(iDynTree::SIX_AXIS_FORCE_TORQUE),false);
+
+    jointPos.zero();
+    jointVel.zero();
+    jointAcc.zero();
+}
+
+SensorsSnapshotTripleBuffer::SensorsSnapshotTripleBuffer(): m_writeIndex(0),
+                                                            m_readIndex(1),
+                                                            m_middleIndex(2),
+                                                            m_newDataAvailable(false)
+{
+}
+
+void SensorsSnapshotTripleBuffer::resize(const iDynTree::Model& model, const iDynTree::SensorsList& sensors)
+{
+    yarp::os::LockGuard guard(m_swapMutex);
+
+    for(int i=0; i < 3; i++)
+    {
+        m_buffers[i].resize(model,sensors);
+    }
+
+    m_newDataAvailable = false;
+}
+
+SensorsSnapshot& SensorsSnapshotTripleBuffer::getWriteBuffer()
+{
+    return m_buffers[m_writeIndex];
+}
+
+void SensorsSnapshotTripleBuffer::publish()
+{
+    yarp::os::LockGuard guard(m_swapMutex);
+
+    int buf = m_middleIndex;
+    m_middleIndex = m_writeIndex;
+    m_writeIndex = buf;
+    m_newDataAvailable = true;
+}
+
+bool SensorsSnapshotTripleBuffer::getLatest(const SensorsSnapshot*& snapshot)
+{
+    bool newData;
+
+    {
+        yarp::os::LockGuard guard(m_swapMutex);
+
+        newData = m_newDataAvailable;
+
+        if( newData )
+        {
+            int buf = m_middleIndex;
+            m_middleIndex = m_readIndex;
+            m_readIndex = buf;
+            m_newDataAvailable = false;
+        }
+    }
+
+    snapshot = &(m_buffers[m_readIndex]);
+
+    return newData;
+}
+
+SensorsAcquisitionThread::SensorsAcquisitionThread(const int periodInMs): RateThread(periodInMs),
+                                                                          m_encs(0),
+                                                                          m_imu(0),
+                                                                          m_readJointVelocities(true),
+                                                                          m_readJointAccelerations(true),
+                                                                          m_readIMU(true),
+                                                                          m_sequenceNumber(0),
+                                                                          m_ftMeasurement(sensorsAcquisition_nrOfChannelsOfYARPFTSensor,0.0),
+                                                                          m_imuMeasurement(sensorsAcquisition_nrOfChannelsOfAYARPIMUSensor,0.0)
+{
+}
+
+void SensorsAcquisitionThread::configure(yarp::dev::IEncoders* encs,
+                                         const std::vector< yarp::dev::IAnalogSensor* >& ftSensors,
+                                         yarp::dev::IGenericSensor* imu,
+                                         const iDynTree::Model& model,
+                                         const iDynTree::SensorsList& sensors)
+{
+    m_encs = encs;
+    m_ftSensors = ftSensors;
+    m_imu = imu;
+
+    m_ftSensorsNames.resize(m_ftSensors.size());
+    for(size_t ft=0; ft < m_ftSensors.size(); ft++)
+    {
+        m_ftSensorsNames[ft] = sensors.getSensor(iDynTree::SIX_AXIS_FORCE_TORQUE,ft)->getName();
+    }
+
+    m_sequenceNumber = 0;
+    m_lastMeasurements.resize(model,sensors);
+    m_bufferJointPos.resize(model);
+    m_bufferJointVel.resize(model);
+    m_bufferJointAcc.resize(model);
+    m_snapshots.resize(model,sensors);
+}
+
+void SensorsAcquisitionThread::setReadOptions(const bool readJointVelocities,
+                                              const bool readJointAccelerations,
+                                              const bool readIMU)
+{
+    yarp::os::LockGuard guard(m_optionsMutex);
+
+    m_readJointVelocities = readJointVelocities;
+    m_readJointAccelerations = readJointAccelerations;
+    m_readIMU = readIMU;
+}
+
+void SensorsAcquisitionThread::acquire()
+{
+    bool readJointVelocities, readJointAccelerations, readIMU;
+
+    {
+        yarp::os::LockGuard guard(m_optionsMutex);
+        readJointVelocities = m_readJointVelocities;
+        readJointAccelerations = m_readJointAccelerations;
+        readIMU = m_readIMU;
+    }
+
+    // The sensors are read in m_lastMeasurements, that is then copied in the snapshot to publish:
+    // for the sensors that are not read correctly, the snapshot contains the last measure read correctly
+    m_lastMeasurements.timestamp = yarp::os::Time::now();
+    m_lastMeasurements.sequenceNumber = m_sequenceNumber++;
+
+    // Read encoders
+    bool ok = m_encs->getEncoders(m_bufferJointPos.data());
+    m_lastMeasurements.encodersReadCorrectly = ok;
+
+    if( !ok )
+    {
+        yWarning() << "wholeBodyDynamics warning : joint positions was not readed correctly, using old measurement";
+    }
+    else
+    {
+        // Convert from degrees (used on wire by YARP) to radians (used by iDynTree)
+        convertFromDegreesToRadians(m_bufferJointPos);
+        m_lastMeasurements.jointPos = m_bufferJointPos;
+    }
+
+    // At the moment we are assuming that all joints are revolute
+
+    if( readJointVelocities )
+    {
+        ok = m_encs->getEncoderSpeeds(m_bufferJointVel.data());
+        m_lastMeasurements.encodersReadCorrectly = m_lastMeasurements.encodersReadCorrectly && ok;
+        if( !ok )
+        {
+            yWarning() << "wholeBodyDynamics warning : joint velocities was not readed correctly, using old measurement";
+        }
+        else
+        {
+            convertFromDegreesToRadians(m_bufferJointVel);
+            m_lastMeasurements.jointVel = m_bufferJointVel;
+        }
+    }
+    else
+    {
+        m_lastMeasurements.jointVel.zero();
+    }
+
+    if( readJointAccelerations )
+    {
+        ok = m_encs->getEncoderAccelerations(m_bufferJointAcc.data());
+        m_lastMeasurements.encodersReadCorrectly = m_lastMeasurements.encodersReadCorrectly && ok;
+        if( !ok )
+        {
+            yWarning() << "wholeBodyDynamics warning : joint accelerations was not readed correctly, using old measurement";
+        }
+        else
+        {
+            convertFromDegreesToRadians(m_bufferJointAcc);
+            m_lastMeasurements.jointAcc = m_bufferJointAcc;
+        }
+    }
+    else
+    {
+        m_lastMeasurements.jointAcc.zero();
+    }
+
+    m_lastMeasurements.readCorrectly = m_lastMeasurements.encodersReadCorrectly;
+
+    // Read F/T sensors
+    for(size_t ft=0; ft < m_ftSensors.size(); ft++ )
+    {
+        ok = readFTSensor(m_ftSensors[ft],m_ftMeasurement,m_bufferWrench);
+        m_lastMeasurements.ftReadCorrectly[ft] = ok;
+        m_lastMeasurements.readCorrectly = m_lastMeasurements.readCorrectly && ok;
+
+        if( !ok )
+        {
+            yWarning() << "wholeBodyDynamics warning : FT sensor " << m_ftSensorsNames[ft] << " was not readed correctly, using old measurement";
+        }
+        else
+        {
+            m_lastMeasurements.ftMeasurements.setMeasurement(iDynTree::SIX_AXIS_FORCE_TORQUE,ft,m_bufferWrench);
+        }
+    }
+
+    // Read IMU Sensor
+    if( readIMU )
+    {
+        ok = readIMUSensor(m_imu,m_imuMeasurement,
+                           m_lastMeasurements.imuLinProperAcc,
+                           m_lastMeasurements.imuAngularVel);
+        m_lastMeasurements.imuReadCorrectly = ok;
+        m_lastMeasurements.readCorrectly = m_lastMeasurements.readCorrectly && ok;
+
+        if( !ok )
+        {
+            yWarning() << "wholeBodyDynamics warning : imu sensor was not readed correctly, using old measurement";
+        }
+    }
+
+    // The buffers of the snapshot have already the right size, so the copy does not allocate memory
+    m_snapshots.getWriteBuffer() = m_lastMeasurements;
+    m_snapshots.publish();
+}
+
+bool SensorsAcquisitionThread::getLatestSnapshot(const SensorsSnapshot*& snapshot)
+{
+    return m_snapshots.getLatest(snapshot);
+}
+
+void SensorsAcquisitionThread::run()
+{
+    acquire();
+}
+
+}
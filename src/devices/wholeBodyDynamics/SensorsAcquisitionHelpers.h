@@ -0,0 +1,206 @@
+#ifndef SENSORS_ACQUISITION_HELPERS_H
+#define SENSORS_ACQUISITION_HELPERS_H
+
+// YARP includes
+#include <yarp/os/Mutex.h>
+#include <yarp/os/RateThread.h>
+#include <yarp/dev/ControlBoardInterfaces.h>
+#include <yarp/dev/IAnalogSensor.h>
+#include <yarp/dev/GenericSensorInterfaces.h>
+#include <yarp/sig/Vector.h>
+
+// iDynTree includes
+#include <iDynTree/Core/VectorFixSize.h>
+#include <iDynTree/Model/Model.h>
+#include <iDynTree/Model/JointState.h>
+#include <iDynTree/Sensors/Sensors.h>
+
+#include <vector>
+
+namespace wholeBodyDynamics
+{
+
+/**
+ * Timestamped snapshot of all the sensors used by wholeBodyDynamics.
+ *
+ * Joint quantities are in radians, the IMU angular velocity in rad/s.
+ */
+struct SensorsSnapshot
+{
+    double timestamp;
+    unsigned long sequenceNumber;
+
+    iDynTree::JointPosDoubleArray  jointPos;
+    iDynTree::JointDOFsDoubleArray jointVel;
+    iDynTree::JointDOFsDoubleArray jointAcc;
+
+    /**
+     * Only the Six Axis Force Torque measures are used.
+     */
+    iDynTree::SensorsMeasurements  ftMeasurements;
+
+    iDynTree::Vector3 imuLinProperAcc;
+    iDynTree::Vector3 imuAngularVel;
+
+    /**
+     * True if all the read sensors were read correctly,
+     * false otherwise (the last measure read correctly is kept for the sensors not read correctly).
+     */
+    bool readCorrectly;
+
+    /**
+     * Per sensor read status: when false, the corresponding measure is
+     * the last one read correctly, acquired in a previous snapshot.
+     */
+    bool encodersReadCorrectly;
+    std::vector<bool> ftReadCorrectly;
+    bool imuReadCorrectly;
+
+    SensorsSnapshot();
+
+    void resize(const iDynTree::Model & model, const iDynTree::SensorsList & sensors);
+};
+
+/**
+ * Read a six axis F/T sensor.
+ *
+ * @param[in] ftSensor the sensor to read.
+ * @param[out] ftMeasurement buffer for the measure on wire, of 6 channels.
+ * @param[out] wrench the measured wrench, updated only if the read was successful.
+ * @return true if the sensor was read correctly, false otherwise.
+ */
+bool readFTSensor(yarp::dev::IAnalogSensor * ftSensor,
+                  yarp::sig::Vector & ftMeasurement,
+                  iDynTree::Wrench & wrench);
+
+/**
+ * Read an IMU, with the format described in http://wiki.icub.org/wiki/Inertial_Sensor .
+ *
+ * @param[in] imu the sensor to read.
+ * @param[out] imuMeasurement buffer for the measure on wire, of 12 channels.
+ * @param[out] linProperAcc the measured proper acceleration, updated only if the read was successful.
+ * @param[out] angularVel the measured angular velocity in rad/s, updated only if the read was successful.
+ * @return true if the sensor was read correctly, false otherwise.
+ */
+bool readIMUSensor(yarp::dev::IGenericSensor * imu,
+                   yarp::sig::Vector & imuMeasurement,
+                   iDynTree::Vector3 & linProperAcc,
+                   iDynTree::Vector3 & angularVel);
+
+/**
+ * Triple buffer of SensorsSnapshot, for a single producer and a single consumer.
+ *
+ * The producer fills the snapshot returned by getWriteBuffer() and calls publish(),
+ * the consumer calls getLatest() to get the latest published snapshot.
+ * Neither of the two ever waits for the other to finish reading or writing
+ * a snapshot: the internal mutex is only held to swap two indices.
+ */
+class SensorsSnapshotTripleBuffer
+{
+private:
+    SensorsSnapshot m_buffers[3];
+    int m_writeIndex;
+    int m_readIndex;
+    int m_middleIndex;
+    bool m_newDataAvailable;
+    yarp::os::Mutex m_swapMutex;
+
+public:
+    SensorsSnapshotTripleBuffer();
+
+    void resize(const iDynTree::Model & model, const iDynTree::SensorsList & sensors);
+
+    /**
+     * Snapshot owned by the producer.
+     */
+    SensorsSnapshot & getWriteBuffer();
+
+    /**
+     * Make the snapshot returned by getWriteBuffer() available to the consumer.
+     */
+    void publish();
+
+    /**
+     * Get the latest published snapshot.
+     *
+     * @param[out] snapshot reference to the latest snapshot, valid until the next call to getLatest .
+     * @return true if a new snapshot was published after the last call to getLatest, false otherwise.
+     */
+    bool getLatest(const SensorsSnapshot * & snapshot);
+};
+
+/**
+ * Class reading all the sensors used by wholeBodyDynamics in a SensorsSnapshotTripleBuffer.
+ *
+ * The acquisition can be performed synchronously (calling acquire() in the estimation thread),
+ * or asynchronously, starting the thread: in this case the blocking reads of the controlboards,
+ * F/T sensors and IMU are performed in the acquisition thread, and the estimation thread can just
+ * consume the latest snapshot with getLatestSnapshot(), without blocking.
+ */
+class SensorsAcquisitionThread: public yarp::os::RateThread
+{
+private:
+    yarp::dev::IEncoders * m_encs;
+    std::vector<yarp::dev::IAnalogSensor *> m_ftSensors;
+    yarp::dev::IGenericSensor * m_imu;
+    std::vector<std::string> m_ftSensorsNames;
+
+    // Options, protected by m_optionsMutex
+    yarp::os::Mutex m_optionsMutex;
+    bool m_readJointVelocities;
+    bool m_readJointAccelerations;
+    bool m_readIMU;
+
+    unsigned long m_sequenceNumber;
+
+    // Last measure read correctly of each sensor, copied in each published snapshot
+    SensorsSnapshot m_lastMeasurements;
+
+    iDynTree::JointPosDoubleArray  m_bufferJointPos;
+    iDynTree::JointDOFsDoubleArray m_bufferJointVel;
+    iDynTree::JointDOFsDoubleArray m_bufferJointAcc;
+    yarp::sig::Vector m_ftMeasurement;
+    yarp::sig::Vector m_imuMeasurement;
+    iDynTree::Wrench m_bufferWrench;
+
+    SensorsSnapshotTripleBuffer m_snapshots;
+
+public:
+    SensorsAcquisitionThread(const int periodInMs);
+
+    /**
+     * Configure the interfaces to read and allocate the snapshots.
+     * @note it shall be called when the thread is not running.
+     */
+    void configure(yarp::dev::IEncoders * encs,
+                   const std::vector<yarp::dev::IAnalogSensor *> & ftSensors,
+                   yarp::dev::IGenericSensor * imu,
+                   const iDynTree::Model & model,
+                   const iDynTree::SensorsList & sensors);
+
+    /**
+     * Select which (optional) quantities are read.
+     * Joint velocities and accelerations that are not read are set to zero.
+     */
+    void setReadOptions(const bool readJointVelocities,
+                        const bool readJointAccelerations,
+                        const bool readIMU);
+
+    /**
+     * Read all the sensors and publish the resulting snapshot.
+     */
+    void acquire();
+
+    /**
+     * Get the latest acquired snapshot.
+     * @see SensorsSnapshotTripleBuffer::getLatest
+     */
+    bool getLatestSnapshot(const SensorsSnapshot * & snapshot);
+
+    // RATE THREAD
+    virtual void run();
+};
+
+}
+
+#endif
@@ -52,6 +52,81 @@ iDynTree::Wrench SixAxisForceTorqueMeasureProcessor::applySecondaryCalibrationMa
     return ret;
 }
 
+SixAxisForceTorqueFilterBank::SixAxisForceTorqueFilterBank(): m_filter(0),
+                                                              m_input(0),
+                                                              m_cutFrequency(0.0),
+                                                              m_sampleTime(0.0),
+                                                              m_nrOfFTSensors(0)
+{
+}
+
+void SixAxisForceTorqueFilterBank::init(const size_t nrOfFTSensors,
+                                        const double cutFrequency,
+                                        const double sampleTime)
+{
+    m_nrOfFTSensors = nrOfFTSensors;
+    m_cutFrequency = cutFrequency;
+    m_sampleTime = sampleTime;
+
+    m_input.setZero(6*nrOfFTSensors);
+    m_filter = iCub::ctrl::realTime::FixedOrderFilter<1,Eigen::Dynamic>(6*nrOfFTSensors);
+    computeCoeff();
+    m_filter.init(m_input);
+}
+
+void SixAxisForceTorqueFilterBank::computeCoeff()
+{
+    Eigen::Vector2d num, den;
+    iCub::ctrl::realTime::computeFirstOrderLowPassCoeffs(m_cutFrequency,m_sampleTime,num,den);
+    m_filter.adjustCoeffs(num,den);
+}
+
+bool SixAxisForceTorqueFilterBank::setCutFrequency(const double cutFrequency)
+{
+    if( cutFrequency <= 0.0 )
+    {
+        return false;
+    }
+
+    // As in FirstOrderLowPassFilter, update the coefficients only if the cutoff changed
+    if( m_cutFrequency != cutFrequency )
+    {
+        m_cutFrequency = cutFrequency;
+        computeCoeff();
+    }
+
+    return true;
+}
+
+size_t SixAxisForceTorqueFilterBank::getNrOfFTSensors() const
+{
+    return m_nrOfFTSensors;
+}
+
+void SixAxisForceTorqueFilterBank::filt(const std::vector<SixAxisForceTorqueMeasureProcessor> & processors,
+                                        const iDynTree::SensorsMeasurements & input,
+                                              iDynTree::SensorsMeasurements & output)
+{
+    // Gather all the measures (with the offset removed) in the contiguous input buffer
+    for(size_t ft=0; ft < m_nrOfFTSensors; ft++)
+    {
+        input.getMeasurement(iDynTree::SIX_AXIS_FORCE_TORQUE,ft,m_bufferWrench);
+
+        m_input.segment<6>(6*ft).noalias() = toEigen(processors[ft].secondaryCalibrationMatrix())*toEigen(m_bufferWrench);
+        m_input.segment<6>(6*ft) -= toEigen(processors[ft].offset());
+    }
+
+    // Filter all the channels at once
+    const Eigen::VectorXd & filtered = m_filter.filt(m_input);
+
+    // Scatter the filtered measures
+    for(size_t ft=0; ft < m_nrOfFTSensors; ft++)
+    {
+        fromEigen(m_bufferWrench,filtered.segment<6>(6*ft));
+        output.setMeasurement(iDynTree::SIX_AXIS_FORCE_TORQUE,ft,m_bufferWrench);
+    }
+}
+
 }
 
 
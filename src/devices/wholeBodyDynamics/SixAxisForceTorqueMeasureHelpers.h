@@ -4,6 +4,12 @@
 // iDynTree includes
 #include <iDynTree/Core/Wrench.h>
 #include <iDynTree/Core/MatrixFixSize.h>
+#include <iDynTree/Sensors/Sensors.h>
+
+// Filters
+#include "ctrlLibRT/filters.h"
+
+#include <vector>
 
 
 namespace wholeBodyDynamics
@@ -70,6 +76,64 @@ public:
     iDynTree::Wrench applySecondaryCalibrationMatrix(const iDynTree::Wrench & input) const;
 };
 
+/**
+ * Bank of first order low pass filters for all the Six Axis Force Torque
+ * sensors of the robot.
+ *
+ * The 6*N channels of the N F/T sensors are stored contiguously
+ * (the six components of the first sensor, then the six of the second, ...)
+ * in a single iCub::ctrl::realTime::FixedOrderFilter, so that all the
+ * sensors are filtered in one vectorized pass, without allocating
+ * one filter per sensor or converting each measure to a yarp::sig::Vector.
+ *
+ * The measures are read from and written to iDynTree::SensorsMeasurements
+ * directly, and the affine processing of each SixAxisForceTorqueMeasureProcessor
+ * (secondary calibration matrix and offset) is applied while gathering the inputs.
+ */
+class SixAxisForceTorqueFilterBank
+{
+private:
+    iCub::ctrl::realTime::FixedOrderFilter<1,Eigen::Dynamic> m_filter;
+    Eigen::VectorXd m_input;
+    iDynTree::Wrench m_bufferWrench;
+    double m_cutFrequency;
+    double m_sampleTime;
+    size_t m_nrOfFTSensors;
+
+    void computeCoeff();
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    SixAxisForceTorqueFilterBank();
+
+    /**
+     * Allocate the buffers for nrOfFTSensors sensors and reset the filter state to zero.
+     */
+    void init(const size_t nrOfFTSensors, const double cutFrequency, const double sampleTime);
+
+    /**
+     * Change the cut frequency of all the filters.
+     */
+    bool setCutFrequency(const double cutFrequency);
+
+    /**
+     * Get the number of filtered sensors.
+     */
+    size_t getNrOfFTSensors() const;
+
+    /**
+     * Remove the offset from the raw F/T measures in input and filter them.
+     *
+     * @param processors vector of getNrOfFTSensors() measure processors, one for each F/T sensor.
+     * @param input raw measurements, only the Six Axis Force Torque measures are read.
+     * @param output filtered measurements, only the Six Axis Force Torque measures are written.
+     */
+    void filt(const std::vector<SixAxisForceTorqueMeasureProcessor> & processors,
+              const iDynTree::SensorsMeasurements & input,
+                    iDynTree::SensorsMeasurements & output);
+};
+
 }
 
 #endif
@@ -23,14 +23,39 @@ namespace dev
 const size_t wholeBodyDynamics_nrOfChannelsOfYARPFTSensor = 6;
 const size_t wholeBodyDynamics_nrOfChannelsOfAYARPIMUSensor = 12;
 const double wholeBodyDynamics_sensorTimeoutInSeconds = 2.0;
-
-WholeBodyDynamicsDevice::WholeBodyDynamicsDevice(): RateThread(10),
+const double wholeBodyDynamics_timingPublishingPeriodInSeconds = 1.0;
+const int wholeBodyDynamics_periodInMilliseconds = 10;
+const double wholeBodyDynamics_maxSensorsSnapshotAgeInSeconds = 5*wholeBodyDynamics_periodInMilliseconds/1000.0;
+
+/**
+ * Stages of the WholeBodyDynamicsDevice::run method, as timed by the PipelineTimingRecorder.
+ */
+enum wholeBodyDynamicsPipelineStage
+{
+    READ_SENSORS_STAGE = 0,
+    FILTER_SENSORS_STAGE,
+    UPDATE_KINEMATICS_STAGE,
+    READ_CONTACT_POINTS_STAGE,
+    COMPUTE_CALIBRATION_STAGE,
+    COMPUTE_ESTIMATION_STAGE,
+    PUBLISH_STAGE,
+    NR_OF_PIPELINE_STAGES
+};
+
+WholeBodyDynamicsDevice::WholeBodyDynamicsDevice(): RateThread(wholeBodyDynamics_periodInMilliseconds),
                                                     portPrefix("/wholeBodyDynamics"),
                                                     correctlyConfigured(false),
                                                     sensorReadCorrectly(false),
                                                     estimationWentWell(false),
                                                     validOffsetAvailable(false),
-                                                    settingsEditor(settings)
+                                                    m_gravityCompensationModesRefreshPeriodInMs(100),
+                                                    m_gravCompOffsetsPublisher(wholeBodyDynamics_periodInMilliseconds),
+                                                    m_useSensorsAcquisitionThread(false),
+                                                    m_sensorsAcquisition(wholeBodyDynamics_periodInMilliseconds),
+                                                    m_sensorsSnapshotTooOld(false),
+                                                    m_timingPublishingDecimation(1),
+                                                    m_cyclesSinceLastTimingPublishing(0),
+                                                    m_settingsEditor(m_rpcSettings,m_rpcMutex,m_settingsMailbox)
 {
     // Calibration quantities
     calibrationBuffers.ongoingCalibration = false;
@@ -52,7 +77,7 @@ WholeBodyDynamicsDevice::~WholeBodyDynamicsDevice()
 
 bool WholeBodyDynamicsDevice::openSettingsPort()
 {
-    settingsPort.setReader(settingsEditor);
+    settingsPort.setReader(m_settingsEditor);
 
     bool ok = settingsPort.open(portPrefix+"/settings");
 
@@ -80,6 +105,19 @@ bool WholeBodyDynamicsDevice::openRPCPort()
     return true;
 }
 
+bool WholeBodyDynamicsDevice::openTimingStatisticsPort()
+{
+    bool ok = m_timingStatisticsPort.open(portPrefix+"/timing:o");
+
+    if( !ok )
+    {
+        yError() << "WholeBodyDynamicsDevice: Impossible to open port " << portPrefix+"/timing:o";
+        return false;
+    }
+
+    return true;
+}
+
 bool WholeBodyDynamicsDevice::closeSettingsPort()
 {
     settingsPort.close();
@@ -92,6 +130,12 @@ bool WholeBodyDynamicsDevice::closeRPCPort()
     return true;
 }
 
+bool WholeBodyDynamicsDevice::closeTimingStatisticsPort()
+{
+    m_timingStatisticsPort.close();
+    return true;
+}
+
 bool WholeBodyDynamicsDevice::closeSkinContactListsPorts()
 {
     this->portContactsInput.close();
@@ -222,6 +266,18 @@ bool WholeBodyDynamicsDevice::openRemapperVirtualSensors(os::Searchable& config)
 
     addVectorOfStringToProperty(propRemapper,"axesNames",estimationJointNames);
 
+    // Optionally update the partially remapped parts with a single message
+    if( config.check("coalesceVirtualAnalogSensorsUpdates") )
+    {
+        if( !config.find("coalesceVirtualAnalogSensorsUpdates").isBool() )
+        {
+            yError() << "wholeBodyDynamics : coalesceVirtualAnalogSensorsUpdates is present, but it is not a bool";
+            return false;
+        }
+
+        propRemapper.put("coalesceUpdates",config.find("coalesceVirtualAnalogSensorsUpdates"));
+    }
+
     ok = remappedVirtualAnalogSensors.open(propRemapper);
 
     if( !ok )
@@ -545,6 +601,9 @@ void WholeBodyDynamicsDevice::resizeBuffers()
                  settings.jointAccFilterCutoffInHz,
                  getRate()/1000.0);
 
+    // Resize timing recorder
+    initTimingRecorder();
+
     // Resize external wrenches publishing software
     this->netExternalWrenchesExertedByTheEnviroment.resize(estimator.model());
     bool ok = this->kinDynComp.loadRobotModel(estimator.model());
@@ -556,6 +615,31 @@ void WholeBodyDynamicsDevice::resizeBuffers()
 }
 
 
+void WholeBodyDynamicsDevice::initTimingRecorder()
+{
+    std::vector<std::string> stageNames(NR_OF_PIPELINE_STAGES);
+    stageNames[READ_SENSORS_STAGE]        = "readSensors";
+    stageNames[FILTER_SENSORS_STAGE]      = "filterSensorsAndRemoveSensorOffsets";
+    stageNames[UPDATE_KINEMATICS_STAGE]   = "updateKinematics";
+    stageNames[READ_CONTACT_POINTS_STAGE] = "readContactPoints";
+    stageNames[COMPUTE_CALIBRATION_STAGE] = "computeCalibration";
+    stageNames[COMPUTE_ESTIMATION_STAGE]  = "computeExternalForcesAndJointTorques";
+    stageNames[PUBLISH_STAGE]             = "publishEstimatedQuantities";
+
+    double periodInSeconds = getRate()/1000.0;
+    m_timingRecorder.init(stageNames,periodInSeconds);
+    m_timingRecorder.getStatistics(m_timingStatistics);
+    m_timingStatisticsMailbox.publish(m_timingRecorder);
+
+    // Publish the statistics (approximately) every wholeBodyDynamics_timingPublishingPeriodInSeconds
+    m_timingPublishingDecimation = (size_t)(wholeBodyDynamics_timingPublishingPeriodInSeconds/periodInSeconds);
+    if( m_timingPublishingDecimation == 0 )
+    {
+        m_timingPublishingDecimation = 1;
+    }
+    m_cyclesSinceLastTimingPublishing = 0;
+}
+
 bool WholeBodyDynamicsDevice::loadSettingsFromConfig(os::Searchable& config)
 {
     // Fill setting with their default values
@@ -630,6 +714,19 @@ bool WholeBodyDynamicsDevice::loadSettingsFromConfig(os::Searchable& config)
         return false;
     }
 
+    // Check if the sensors should be read in a separate thread
+    m_useSensorsAcquisitionThread = false;
+    if( prop.check("useSensorsAcquisitionThread") )
+    {
+        if( !prop.find("useSensorsAcquisitionThread").isBool() )
+        {
+            yError() << "wholeBodyDynamics : useSensorsAcquisitionThread is present, but it is not a bool";
+            return false;
+        }
+
+        m_useSensorsAcquisitionThread = prop.find("useSensorsAcquisitionThread").asBool();
+    }
+
     return true;
 }
 
@@ -734,6 +831,17 @@ bool WholeBodyDynamicsDevice::loadGravityCompensationSettingsFromConfig(os::Sear
 
         m_gravityCompensationEnabled = propGravComp.find("enableGravityCompensation").asBool();
 
+        if( propGravComp.check("modesRefreshPeriodInMs") )
+        {
+            if( !(propGravComp.find("modesRefreshPeriodInMs").isInt() && propGravComp.find("modesRefreshPeriodInMs").asInt() > 0) )
+            {
+                yError() << "wholeBodyDynamics: GRAVITY_COMPENSATION group found, but modesRefreshPeriodInMs is not a positive int";
+                return false;
+            }
+
+            m_gravityCompensationModesRefreshPeriodInMs = propGravComp.find("modesRefreshPeriodInMs").asInt();
+        }
+
         std::vector<std::string> gravityCompesationAxes;
 
         ret = getGravityCompensationDOFsList(propGravComp,gravityCompesationAxes);
@@ -793,6 +901,9 @@ bool WholeBodyDynamicsDevice::open(os::Searchable& config)
         return false;
     }
 
+    // The RPC threads start from the loaded settings
+    m_rpcSettings = settings;
+
     // Create the estimator
     ok = this->openEstimator(config);
      if( !ok ) 
@@ -833,6 +944,14 @@ bool WholeBodyDynamicsDevice::open(os::Searchable& config)
         return false;
     } 
 
+    // Open timing statistics port
+    ok = this->openTimingStatisticsPort();
+    if( !ok )
+    {
+        yError() << "wholeBodyDynamics: Problem in opening timing statistics port.";
+        return false;
+    }
+
     // Open the controlboard remapper
     ok = this->openRemapperControlBoard(config);
     if( !ok ) 
@@ -1046,26 +1165,52 @@ bool WholeBodyDynamicsDevice::attachAll(const PolyDriverList& p)
 
     if( ok )
     {
-        correctlyConfigured = true;
-        this->start();
+        // Configure the sensors acquisition, and acquire a first snapshot
+        // so that a valid snapshot is always available to the run method
+        m_sensorsAcquisition.configure(remappedControlBoardInterfaces.encs,ftSensors,imuInterface,
+                                       estimator.model(),estimator.sensors());
+        m_sensorsAcquisition.setReadOptions(settings.useJointVelocity,settings.useJointAcceleration,
+                                            settings.kinematicSource == IMU);
+        m_sensorsAcquisition.acquire();
+
+        if( m_useSensorsAcquisitionThread )
+        {
+            ok = m_sensorsAcquisition.start();
+
+            if( !ok )
+            {
+                yError() << "wholeBodyDynamics : impossible to start the sensors acquisition thread";
+            }
+        }
     }
 
-    return ok;
-}
+    if( ok && m_gravityCompensationEnabled )
+    {
+        // The control and interaction modes are read and the impedance offsets are sent
+        // in a separate thread, so that the estimation never blocks on them
+        int modesRefreshDecimation = m_gravityCompensationModesRefreshPeriodInMs/wholeBodyDynamics_periodInMilliseconds;
+        m_gravCompOffsetsPublisher.configure(remappedControlBoardInterfaces.ctrlmode,
+                                             remappedControlBoardInterfaces.intmode,
+                                             remappedControlBoardInterfaces.impctrl,
+                                             m_gravityCompesationJoints,
+                                             estimator.model(),
+                                             modesRefreshDecimation);
 
-double deg2rad(const double angleInDeg)
-{
-    return angleInDeg*M_PI/180.0;
-}
+        ok = m_gravCompOffsetsPublisher.start();
 
-void convertVectorFromDegreesToRadians(iDynTree::VectorDynSize & vector)
-{
-    for(size_t i=0; i < vector.size(); i++)
+        if( !ok )
+        {
+            yError() << "wholeBodyDynamics : impossible to start the gravity compensation thread";
+        }
+    }
+
+    if( ok )
     {
-        vector(i) = deg2rad(vector(i));
+        correctlyConfigured = true;
+        this->start();
     }
 
-    return;
+    return ok;
 }
 
 bool WholeBodyDynamicsDevice::readFTSensors(bool verbose)
@@ -1074,9 +1219,7 @@ bool WholeBodyDynamicsDevice::readFTSensors(bool verbose)
     for(size_t ft=0; ft < estimator.sensors().getNrOfSensors(iDynTree::SIX_AXIS_FORCE_TORQUE); ft++ )
     {
         iDynTree::Wrench bufWrench;
-        int ftRetVal = ftSensors[ft]->read(ftMeasurement);
-
-        bool ok = (ftRetVal == IAnalogSensor::AS_OK);
+        bool ok = wholeBodyDynamics::readFTSensor(ftSensors[ft],ftMeasurement,bufWrench);
 
         FTSensorsReadCorrectly = FTSensorsReadCorrectly && ok;
 
@@ -1088,9 +1231,6 @@ bool WholeBodyDynamicsDevice::readFTSensors(bool verbose)
 
         if( ok )
         {
-            // Format of F/T measurement in YARP/iDynTree is consistent: linear/angular
-            iDynTree::toiDynTree(ftMeasurement,bufWrench);
-
             rawSensorsMeasurements.setMeasurement(iDynTree::SIX_AXIS_FORCE_TORQUE,ft,bufWrench);
         }
     }
@@ -1104,93 +1244,83 @@ bool WholeBodyDynamicsDevice::readIMUSensors(bool verbose)
     rawIMUMeasurements.linProperAcc.zero();
     rawIMUMeasurements.angularVel.zero();
 
-    bool ok = imuInterface->read(imuMeasurement);
+    bool ok = wholeBodyDynamics::readIMUSensor(imuInterface,imuMeasurement,
+                                               rawIMUMeasurements.linProperAcc,
+                                               rawIMUMeasurements.angularVel);
 
     if( !ok && verbose )
     {
         yWarning() << "wholeBodyDynamics warning : imu sensor was not readed correctly, using old measurement";
     }
 
-    if( ok )
-    {
-        // Check format of IMU in YARP http://wiki.icub.org/wiki/Inertial_Sensor
-        rawIMUMeasurements.angularVel(0) = deg2rad(imuMeasurement[6]);
-        rawIMUMeasurements.angularVel(1) = deg2rad(imuMeasurement[7]);
-        rawIMUMeasurements.angularVel(2) = deg2rad(imuMeasurement[8]);
-
-        rawIMUMeasurements.linProperAcc(0) = imuMeasurement[3];
-        rawIMUMeasurements.linProperAcc(1) = imuMeasurement[4];
-        rawIMUMeasurements.linProperAcc(2) = imuMeasurement[5];
-    }
-
     return ok;
 }
 
 
 void WholeBodyDynamicsDevice::readSensors()
 {
-    // Read encoders
-    sensorReadCorrectly = remappedControlBoardInterfaces.encs->getEncoders(jointPos.data());
+    // Select the quantities that need to be read
+    m_sensorsAcquisition.setReadOptions(settings.useJointVelocity,
+                                        settings.useJointAcceleration,
+                                        settings.kinematicSource == IMU);
 
-    // Convert from degrees (used on wire by YARP) to radians (used by iDynTree)
-    convertVectorFromDegreesToRadians(jointPos);
+    // If the sensors are not read in the acquisition thread, read them now
+    if( !m_useSensorsAcquisitionThread )
+    {
+        m_sensorsAcquisition.acquire();
+    }
 
-    bool ok;
+    // Get the latest snapshot: if the acquisition thread did not produce
+    // a new one since the last cycle, the last one is used again
+    const wholeBodyDynamics::SensorsSnapshot * snapshot = 0;
+    bool newSnapshot = m_sensorsAcquisition.getLatestSnapshot(snapshot);
+
+    sensorReadCorrectly = snapshot->readCorrectly;
 
-    if( !sensorReadCorrectly )
+    // If the acquisition thread is stalled or its reads are too slow the measures are too old:
+    // they are used anyway, but as for a failed read they are not considered read correctly
+    double snapshotAge = yarp::os::Time::now() - snapshot->timestamp;
+    bool snapshotTooOld = m_useSensorsAcquisitionThread && snapshotAge > wholeBodyDynamics_maxSensorsSnapshotAgeInSeconds;
+    if( snapshotTooOld )
     {
-        yWarning() << "wholeBodyDynamics warning : joint positions was not readed correctly";
+        sensorReadCorrectly = false;
     }
 
-    // At the moment we are assuming that all joints are revolute
-
-    if( settings.useJointVelocity )
+    if( snapshotTooOld && !m_sensorsSnapshotTooOld )
     {
-        ok = remappedControlBoardInterfaces.encs->getEncoderSpeeds(jointVel.data());
-        sensorReadCorrectly = sensorReadCorrectly && ok;
-        if( !ok )
+        if( newSnapshot )
         {
-            yWarning() << "wholeBodyDynamics warning : joint velocities was not readed correctly";
+            yWarning() << "wholeBodyDynamics warning : the latest sensors measurements were acquired" << snapshotAge << "seconds ago, using them anyway";
+        }
+        else
+        {
+            yWarning() << "wholeBodyDynamics warning : no new sensors measurements in the last" << snapshotAge << "seconds, using old measurements";
         }
-
-        // Convert from degrees (used on wire by YARP) to radians (used by iDynTree)
-        convertVectorFromDegreesToRadians(jointVel);
     }
-    else
+
+    if( !snapshotTooOld && m_sensorsSnapshotTooOld )
     {
-        jointVel.zero();
+        yInfo() << "wholeBodyDynamics : new sensors measurements available again";
     }
 
-    if( settings.useJointAcceleration )
-    {
-        ok = remappedControlBoardInterfaces.encs->getEncoderAccelerations(jointAcc.data());
-        sensorReadCorrectly = sensorReadCorrectly && ok;
-        if( !ok )
-        {
-            yWarning() << "wholeBodyDynamics warning : joint accelerations was not readed correctly";
-        }
+    m_sensorsSnapshotTooOld = snapshotTooOld;
 
-        // Convert from degrees (used on wire by YARP) to radians (used by iDynTree)
-        convertVectorFromDegreesToRadians(jointAcc);
+    jointPos = snapshot->jointPos;
+    jointVel = snapshot->jointVel;
+    jointAcc = snapshot->jointAcc;
 
-    }
-    else
+    for(size_t ft=0; ft < estimator.sensors().getNrOfSensors(iDynTree::SIX_AXIS_FORCE_TORQUE); ft++ )
     {
-        jointAcc.zero();
+        snapshot->ftMeasurements.getMeasurement(iDynTree::SIX_AXIS_FORCE_TORQUE,ft,m_bufferWrench);
+        rawSensorsMeasurements.setMeasurement(iDynTree::SIX_AXIS_FORCE_TORQUE,ft,m_bufferWrench);
     }
 
-    // Read F/T sensors
-    ok = readFTSensors();
-    sensorReadCorrectly = ok && sensorReadCorrectly;
-
-    // Read IMU Sensor
     if( settings.kinematicSource == IMU )
     {
-        ok = readIMUSensors();
-        sensorReadCorrectly = ok && sensorReadCorrectly;
+        rawIMUMeasurements.linProperAcc = snapshot->imuLinProperAcc;
+        rawIMUMeasurements.angularVel   = snapshot->imuAngularVel;
+        rawIMUMeasurements.angularAcc.zero();
     }
-
-
 }
 
 void WholeBodyDynamicsDevice::filterSensorsAndRemoveSensorOffsets()
@@ -1201,25 +1331,7 @@ void WholeBodyDynamicsDevice::filterSensorsAndRemoveSensorOffsets()
                                   settings.jointAccFilterCutoffInHz);
 
     // Filter and remove offset fromn F/T sensors
-    for(size_t ft=0; ft < estimator.sensors().getNrOfSensors(iDynTree::SIX_AXIS_FORCE_TORQUE); ft++ )
-    {
-        iDynTree::Wrench rawFTMeasure;
-        rawSensorsMeasurements.getMeasurement(iDynTree::SIX_AXIS_FORCE_TORQUE,ft,rawFTMeasure);
-
-        iDynTree::Wrench rawFTMeasureWithOffsetRemoved  = ftProcessors[ft].filt(rawFTMeasure);
-
-        // Filter the data
-        iDynTree::toYarp(rawFTMeasureWithOffsetRemoved,filters.bufferYarp6);
-
-        // Run the filter
-        const yarp::sig::Vector & outputFt = filters.forcetorqueFilters[ft]->filt(filters.bufferYarp6);
-
-        iDynTree::Wrench filteredFTMeasure;
-
-        iDynTree::toiDynTree(outputFt,filteredFTMeasure);
-
-        filteredSensorMeasurements.setMeasurement(iDynTree::SIX_AXIS_FORCE_TORQUE,ft,filteredFTMeasure);
-    }
+    filters.forcetorqueFilters.filt(ftProcessors,rawSensorsMeasurements,filteredSensorMeasurements);
 
     // Filter joint vel
     if( settings.useJointVelocity )
@@ -1263,6 +1375,17 @@ void WholeBodyDynamicsDevice::filterSensorsAndRemoveSensorOffsets()
 
 void WholeBodyDynamicsDevice::updateKinematics()
 {
+    // The link transforms are computed once for each cycle by kinDynComp, and then used both
+    // by the gravity compensation and by the publishing of the external wrenches
+    bool kinDynCompNeeded = m_gravityCompensationEnabled || (this->outputWrenchPorts.size() > 0);
+    if( kinDynCompNeeded )
+    {
+        // Only relative transforms are used, so the gravity of kinDynComp is not relevant
+        iDynTree::Vector3 dummyGravity;
+        dummyGravity.zero();
+        this->kinDynComp.setRobotState(this->jointPos,this->jointVel,dummyGravity);
+    }
+
     // Read IMU Sensor and update the kinematics in the model
     if( settings.kinematicSource == IMU )
     {
@@ -1274,7 +1397,8 @@ void WholeBodyDynamicsDevice::updateKinematics()
 
         if( m_gravityCompensationEnabled )
         {
-            m_gravCompHelper.updateKinematicsFromProperAcceleration(jointPos,
+            m_gravCompHelper.updateKinematicsFromProperAcceleration(kinDynComp,
+                                                                    jointPos,
                                                                     imuFrameIndex,
                                                                     filteredIMUMeasurements.linProperAcc);
         }
@@ -1294,7 +1418,8 @@ void WholeBodyDynamicsDevice::updateKinematics()
 
         if( m_gravityCompensationEnabled )
         {
-            m_gravCompHelper.updateKinematicsFromGravity(jointPos,
+            m_gravCompHelper.updateKinematicsFromGravity(kinDynComp,
+                                                         jointPos,
                                                          fixedFrameIndex,
                                                          gravity);
         }
@@ -1449,47 +1574,10 @@ void WholeBodyDynamicsDevice::publishGravityCompensation()
     if( m_gravityCompensationEnabled )
     {
         this->m_gravCompHelper.getGravityCompensationTorques(this->m_gravityCompensationTorques);
-        // Publish torques only in joints that are in compliant mode that they need it
-
-        for(size_t ii=0; ii < m_gravityCompesationJoints.size(); ii++)
-        {
-            size_t dof = m_gravityCompesationJoints[ii];
-
-            int ctrl_mode=0;
-            yarp::dev::InteractionModeEnum int_mode;
-            remappedControlBoardInterfaces.ctrlmode->getControlMode(dof,&ctrl_mode);
-            remappedControlBoardInterfaces.intmode->getInteractionMode(dof,&int_mode);
 
-            switch(ctrl_mode)
-            {
-                //for all this control modes do nothing
-                case VOCAB_CM_OPENLOOP:
-                case VOCAB_CM_IDLE:
-                case VOCAB_CM_UNKNOWN:
-                case VOCAB_CM_HW_FAULT:
-                    break;
-
-                case VOCAB_CM_TORQUE:
-                    // We don't do anything in torque mode, differently from the
-                    // old gravity compensation : because otherwise we interfere
-                    // with any torque control loop
-                    break;
-
-                case VOCAB_CM_POSITION:
-                case VOCAB_CM_POSITION_DIRECT:
-                case VOCAB_CM_MIXED:
-                case VOCAB_CM_VELOCITY:
-                     if (int_mode == VOCAB_IM_COMPLIANT)
-                     {
-                         remappedControlBoardInterfaces.impctrl->setImpedanceOffset((int)dof,this->m_gravityCompensationTorques(dof));
-                     }
-                     else
-                     {
-                         //stiff or unknown mode, nothing to do
-                     }
-                     break;
-            }
-        }
+        // The torques are published only in joints that are in compliant mode
+        // by the m_gravCompOffsetsPublisher thread, using the cached modes
+        m_gravCompOffsetsPublisher.publishTorques(this->m_gravityCompensationTorques);
     }
 }
 
@@ -1497,13 +1585,13 @@ void WholeBodyDynamicsDevice::resetGravityCompensation()
 {
     if( m_gravityCompensationEnabled )
     {
-        for(size_t ii=0; ii < m_gravityCompesationJoints.size(); ii++)
+        if( m_gravCompOffsetsPublisher.isRunning() )
         {
-            size_t dof = m_gravityCompesationJoints[ii];
-
-            // Regardless of the controlmode, we reset the setImpedanceOffset
-            remappedControlBoardInterfaces.impctrl->setImpedanceOffset((int)dof,0.0);
+            m_gravCompOffsetsPublisher.stop();
         }
+
+        // Regardless of the controlmode, we reset the setImpedanceOffset
+        m_gravCompOffsetsPublisher.resetOffsets();
     }
 }
 
@@ -1545,10 +1633,7 @@ void WholeBodyDynamicsDevice::publishExternalWrenches()
 {
     if( this->outputWrenchPorts.size() > 0 )
     {
-        // Update kinDynComp model
-        iDynTree::Vector3 dummyGravity;
-        dummyGravity.zero();
-        this->kinDynComp.setRobotState(this->jointPos,this->jointVel,dummyGravity);
+        // The kinDynComp state was already set in updateKinematics
 
         // Compute net wrenches for each link
         estimateExternalContactWrenches.computeNetWrenches(netExternalWrenchesExertedByTheEnviroment);
@@ -1574,35 +1659,69 @@ void WholeBodyDynamicsDevice::publishExternalWrenches()
     }
 }
 
+void WholeBodyDynamicsDevice::publishTimingStatistics()
+{
+    m_cyclesSinceLastTimingPublishing++;
+
+    if( m_cyclesSinceLastTimingPublishing >= m_timingPublishingDecimation )
+    {
+        m_cyclesSinceLastTimingPublishing = 0;
+
+        // Make the statistics available to the RPC thread, unless it is reading them in this moment
+        m_timingStatisticsMailbox.tryPublish(m_timingRecorder);
+
+        if( m_timingStatisticsPort.getOutputCount() > 0 )
+        {
+            m_timingRecorder.getStatistics(m_timingStatistics);
+            broadcastData<yarp::sig::Vector>(m_timingStatistics,m_timingStatisticsPort);
+        }
+    }
+}
+
 void WholeBodyDynamicsDevice::run()
 {
     yarp::os::LockGuard guard(this->deviceMutex);
 
     if( correctlyConfigured )
     {
-        // Load settings if modified
-        //this->reconfigureClassFromSettings();
+        m_timingRecorder.startCycle();
+
+        // Load settings if modified and process the commands received by the RPC thread
+        // (accounted in the read sensors stage)
+        this->processRPCCommands();
 
         // Read sensor readings
         this->readSensors();
+        m_timingRecorder.endStage(READ_SENSORS_STAGE);
 
         // Filter sensor and remove offset
         this->filterSensorsAndRemoveSensorOffsets();
+        m_timingRecorder.endStage(FILTER_SENSORS_STAGE);
 
         // Update kinematics
         this->updateKinematics();
+        m_timingRecorder.endStage(UPDATE_KINEMATICS_STAGE);
 
         // Read contacts info from the skin or from assume contact location
         this->readContactPoints();
+        m_timingRecorder.endStage(READ_CONTACT_POINTS_STAGE);
 
         // Compute calibration if we are in calibration mode
         this->computeCalibration();
+        m_timingRecorder.endStage(COMPUTE_CALIBRATION_STAGE);
 
         // Compute estimated external forces and internal joint torques
         this->computeExternalForcesAndJointTorques();
+        m_timingRecorder.endStage(COMPUTE_ESTIMATION_STAGE);
 
         // Publish estimated quantities
         this->publishEstimatedQuantities();
+        m_timingRecorder.endStage(PUBLISH_STAGE);
+
+        m_timingRecorder.endCycle();
+
+        // Publish the timing statistics, if it is the case
+        this->publishTimingStatistics();
     }
 }
 
@@ -1617,6 +1736,11 @@ bool WholeBodyDynamicsDevice::detachAll()
         stop();
     }
 
+    if( m_sensorsAcquisition.isRunning() )
+    {
+        m_sensorsAcquisition.stop();
+    }
+
     // If gravity compensation was enabled, reset the offsets
     this->resetGravityCompensation();
 
@@ -1627,6 +1751,7 @@ bool WholeBodyDynamicsDevice::detachAll()
     closeExternalWrenchesPorts();
     closeRPCPort();
     closeSettingsPort();
+    closeTimingStatisticsPort();
     closeSkinContactListsPorts();
 
 
@@ -1645,11 +1770,6 @@ bool WholeBodyDynamicsDevice::close()
 
 bool WholeBodyDynamicsDevice::setupCalibrationWithExternalWrenchOnOneFrame(const std::string & frameName, const int32_t nrOfSamples)
 {
-    // Let's configure the external forces that then are assume to be active on the robot while calibration
-
-    // Clear the class
-    calibrationBuffers.assumedContactLocationsForCalibration.clear();
-
     // Check if the frame exist
     iDynTree::FrameIndex frameIndex = estimator.model().getFrameIndex(frameName);
     if( frameIndex == iDynTree::FRAME_INVALID_INDEX )
@@ -1658,20 +1778,7 @@ bool WholeBodyDynamicsDevice::setupCalibrationWithExternalWrenchOnOneFrame(const
         return false;
     }
 
-    // We assume that the contact is a 6-D the origin of the frame
-    iDynTree::UnknownWrenchContact calibrationAssumedContact(iDynTree::FULL_WRENCH,iDynTree::Position::Zero());
-
-    bool ok = calibrationBuffers.assumedContactLocationsForCalibration.addNewContactInFrame(estimator.model(),frameIndex,calibrationAssumedContact);
-
-    if( !ok )
-    {
-        yError() << "wholeBodyDynamics : setupCalibrationWithExternalWrenchOnOneFrame error for frame " << frameName;
-        return false;
-    }
-
-    setupCalibrationCommonPart(nrOfSamples);
-
-    return true;
+    return setupCalibrationWithExternalWrenchesOnFrames(frameIndex,iDynTree::FRAME_INVALID_INDEX,nrOfSamples);
 }
 
 void WholeBodyDynamicsDevice::setupCalibrationCommonPart(const int32_t nrOfSamples)
@@ -1695,35 +1802,47 @@ void WholeBodyDynamicsDevice::setupCalibrationCommonPart(const int32_t nrOfSampl
 
 bool WholeBodyDynamicsDevice::setupCalibrationWithExternalWrenchesOnTwoFrames(const std::string & frame1Name, const std::string & frame2Name, const int32_t nrOfSamples)
 {
-    // Let's configure the external forces that then are assume to be active on the robot while calibration on two links (assumed to be simmetric)
-
-    // Clear the class
-    calibrationBuffers.assumedContactLocationsForCalibration.clear();
-
     // Check if the frame exist
     iDynTree::FrameIndex frame1Index = estimator.model().getFrameIndex(frame1Name);
     if( frame1Index == iDynTree::FRAME_INVALID_INDEX )
     {
-        yError() << "wholeBodyDynamics : setupCalibrationWithExternalWrenchesOnTwoFrames impossible to find frame " << frame1Index;
+        yError() << "wholeBodyDynamics : setupCalibrationWithExternalWrenchesOnTwoFrames impossible to find frame " << frame1Name;
         return false;
     }
 
     iDynTree::FrameIndex frame2Index = estimator.model().getFrameIndex(frame2Name);
     if( frame2Index == iDynTree::FRAME_INVALID_INDEX )
     {
-        yError() << "wholeBodyDynamics : setupCalibrationWithExternalWrenchesOnTwoFrames impossible to find frame " << frame2Index;
+        yError() << "wholeBodyDynamics : setupCalibrationWithExternalWrenchesOnTwoFrames impossible to find frame " << frame2Name;
         return false;
     }
 
-    // We assume that both  contacts are a 6-D Wrench the origin of the frame
+    return setupCalibrationWithExternalWrenchesOnFrames(frame1Index,frame2Index,nrOfSamples);
+}
+
+bool WholeBodyDynamicsDevice::setupCalibrationWithExternalWrenchesOnFrames(const iDynTree::FrameIndex firstFrame,
+                                                                            const iDynTree::FrameIndex secondFrame,
+                                                                            const int32_t nrOfSamples)
+{
+    // Let's configure the external forces that then are assume to be active on the robot while calibration
+    // (if two frames are used, they are assumed to be simmetric)
+
+    // Clear the class
+    calibrationBuffers.assumedContactLocationsForCalibration.clear();
+
+    // We assume that the contacts are a 6-D Wrench the origin of the frame
     iDynTree::UnknownWrenchContact calibrationAssumedContact(iDynTree::FULL_WRENCH,iDynTree::Position::Zero());
 
-    bool ok = calibrationBuffers.assumedContactLocationsForCalibration.addNewContactInFrame(estimator.model(),frame1Index,calibrationAssumedContact);
-    ok = ok && calibrationBuffers.assumedContactLocationsForCalibration.addNewContactInFrame(estimator.model(),frame2Index,calibrationAssumedContact);
+    bool ok = calibrationBuffers.assumedContactLocationsForCalibration.addNewContactInFrame(estimator.model(),firstFrame,calibrationAssumedContact);
+
+    if( secondFrame != iDynTree::FRAME_INVALID_INDEX )
+    {
+        ok = ok && calibrationBuffers.assumedContactLocationsForCalibration.addNewContactInFrame(estimator.model(),secondFrame,calibrationAssumedContact);
+    }
 
     if( !ok )
     {
-        yError() << "wholeBodyDynamics : setupCalibrationWithExternalWrenchesOnTwoFrames error";
+        yError() << "wholeBodyDynamics : setupCalibrationWithExternalWrenchesOnFrames error";
         return false;
     }
 
@@ -1732,13 +1851,84 @@ bool WholeBodyDynamicsDevice::setupCalibrationWithExternalWrenchesOnTwoFrames(co
     return true;
 }
 
-bool WholeBodyDynamicsDevice::calib(const std::string& calib_code, const int32_t nr_of_samples)
+bool WholeBodyDynamicsDevice::pushRPCCommand(const wholeBodyDynamicsCommand& command)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    bool ok = m_commandsQueue.push(command);
+
+    if( !ok )
+    {
+        yError() << "wholeBodyDynamics : too many commands waiting to be processed by the estimation thread, command discarded";
+        return false;
+    }
+
+    return true;
+}
+
+bool WholeBodyDynamicsDevice::requestCalibration(const std::string & firstFrameName,
+                                                 const std::string & secondFrameName,
+                                                 const int32_t nrOfSamples)
+{
+    // The model is not modified after open, so it can be used to check the frames in the RPC thread
+    wholeBodyDynamicsCommand command;
+    command.type = START_CALIBRATION_COMMAND;
+    command.nrOfSamples = nrOfSamples;
+    command.firstFrame = estimator.model().getFrameIndex(firstFrameName);
+    command.secondFrame = iDynTree::FRAME_INVALID_INDEX;
+
+    if( command.firstFrame == iDynTree::FRAME_INVALID_INDEX )
+    {
+        yError() << "wholeBodyDynamics : impossible to find frame " << firstFrameName;
+        return false;
+    }
 
+    if( !secondFrameName.empty() )
+    {
+        command.secondFrame = estimator.model().getFrameIndex(secondFrameName);
+
+        if( command.secondFrame == iDynTree::FRAME_INVALID_INDEX )
+        {
+            yError() << "wholeBodyDynamics : impossible to find frame " << secondFrameName;
+            return false;
+        }
+    }
+
+    return pushRPCCommand(command);
+}
+
+void WholeBodyDynamicsDevice::processRPCCommands()
+{
+    // Load the settings, if they were modified by the RPC thread
+    m_settingsMailbox.tryFetch(settings);
+
+    int nrOfCommands = m_commandsQueue.tryPopAll(m_commandsBuffer);
+
+    for(int i=0; i < nrOfCommands; i++)
+    {
+        const wholeBodyDynamicsCommand & command = m_commandsBuffer[i];
+
+        switch( command.type )
+        {
+            case START_CALIBRATION_COMMAND:
+                this->setupCalibrationWithExternalWrenchesOnFrames(command.firstFrame,command.secondFrame,command.nrOfSamples);
+                break;
+            case RESET_OFFSET_COMMAND:
+                for(size_t ft = 0; ft < this->getNrOfFTSensors(); ft++)
+                {
+                    ftProcessors[ft].offset().zero();
+                }
+                break;
+            case RESET_TIMING_STATISTICS_COMMAND:
+                m_timingRecorder.reset();
+                break;
+        }
+    }
+}
+
+bool WholeBodyDynamicsDevice::calib(const std::string& calib_code, const int32_t nr_of_samples)
+{
     yWarning() << "wholeBodyDynamics : calib ignoring calib_code " << calib_code;
 
-    bool ok = this->setupCalibrationWithExternalWrenchOnOneFrame("base_link",nr_of_samples);
+    bool ok = this->requestCalibration("base_link","",nr_of_samples);
 
     if( !ok )
     {
@@ -1751,11 +1941,9 @@ bool WholeBodyDynamicsDevice::calib(const std::string& calib_code, const int32_t
 
 bool WholeBodyDynamicsDevice::calibStanding(const std::string& calib_code, const int32_t nr_of_samples)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
-
     yWarning() << "wholeBodyDynamics : calibStanding ignoring calib_code " << calib_code;
 
-    bool ok = this->setupCalibrationWithExternalWrenchesOnTwoFrames("r_sole","l_sole",nr_of_samples);
+    bool ok = this->requestCalibration("r_sole","l_sole",nr_of_samples);
 
     if( !ok )
     {
@@ -1768,11 +1956,9 @@ bool WholeBodyDynamicsDevice::calibStanding(const std::string& calib_code, const
 
 bool WholeBodyDynamicsDevice::calibStandingLeftFoot(const std::string& calib_code, const int32_t nr_of_samples)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
-
     yWarning() << " wholeBodyDynamics : calibStandingLeftFoot ignoring calib_code " << calib_code;
 
-    bool ok = this->setupCalibrationWithExternalWrenchOnOneFrame("l_sole",nr_of_samples);
+    bool ok = this->requestCalibration("l_sole","",nr_of_samples);
 
     if( !ok )
     {
@@ -1784,11 +1970,9 @@ bool WholeBodyDynamicsDevice::calibStandingLeftFoot(const std::string& calib_cod
 
 bool WholeBodyDynamicsDevice::calibStandingRightFoot(const std::string& calib_code, const int32_t nr_of_samples)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
-
     yWarning() << " wholeBodyDynamics : calibStandingRightFoot ignoring calib_code " << calib_code;
 
-    bool ok = this->setupCalibrationWithExternalWrenchOnOneFrame("r_sole",nr_of_samples);
+    bool ok = this->requestCalibration("r_sole","",nr_of_samples);
 
     if( !ok )
     {
@@ -1801,16 +1985,15 @@ bool WholeBodyDynamicsDevice::calibStandingRightFoot(const std::string& calib_co
 
 bool WholeBodyDynamicsDevice::resetOffset(const std::string& calib_code)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
-
     yWarning() << "wholeBodyDynamics : calib ignoring calib_code " << calib_code;
 
-    for(size_t ft = 0; ft < this->getNrOfFTSensors(); ft++)
-    {
-        ftProcessors[ft].offset().zero();
-    }
+    wholeBodyDynamicsCommand command;
+    command.type = RESET_OFFSET_COMMAND;
+    command.firstFrame = iDynTree::FRAME_INVALID_INDEX;
+    command.secondFrame = iDynTree::FRAME_INVALID_INDEX;
+    command.nrOfSamples = 0;
 
-    return true;
+    return pushRPCCommand(command);
 }
 
 
@@ -1822,48 +2005,51 @@ bool WholeBodyDynamicsDevice::changeFixedLinkSimpleLeggedOdometry(const std::str
 
 double WholeBodyDynamicsDevice::get_forceTorqueFilterCutoffInHz()
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    return this->settings.forceTorqueFilterCutoffInHz;
+    return this->m_rpcSettings.forceTorqueFilterCutoffInHz;
 }
 
 bool WholeBodyDynamicsDevice::set_forceTorqueFilterCutoffInHz(const double newCutoff)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    this->settings.forceTorqueFilterCutoffInHz = newCutoff;
+    this->m_rpcSettings.forceTorqueFilterCutoffInHz = newCutoff;
+    m_settingsMailbox.publish(m_rpcSettings);
 
     return true;
 }
 
 double WholeBodyDynamicsDevice::get_jointVelFilterCutoffInHz()
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    return this->settings.jointVelFilterCutoffInHz;
+    return this->m_rpcSettings.jointVelFilterCutoffInHz;
 }
 
 bool WholeBodyDynamicsDevice::set_jointVelFilterCutoffInHz(const double newCutoff)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    this->settings.jointVelFilterCutoffInHz = newCutoff;
+    this->m_rpcSettings.jointVelFilterCutoffInHz = newCutoff;
+    m_settingsMailbox.publish(m_rpcSettings);
 
     return true;
 }
 
 double WholeBodyDynamicsDevice::get_jointAccFilterCutoffInHz()
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    return this->settings.jointAccFilterCutoffInHz;
+    return this->m_rpcSettings.jointAccFilterCutoffInHz;
 }
 
 bool WholeBodyDynamicsDevice::set_jointAccFilterCutoffInHz(const double newCutoff)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    this->settings.jointAccFilterCutoffInHz = newCutoff;
+    this->m_rpcSettings.jointAccFilterCutoffInHz = newCutoff;
+    m_settingsMailbox.publish(m_rpcSettings);
 
     return true;
 }
@@ -1871,23 +2057,24 @@ bool WholeBodyDynamicsDevice::set_jointAccFilterCutoffInHz(const double newCutof
 
 double WholeBodyDynamicsDevice::get_imuFilterCutoffInHz()
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    return this->settings.imuFilterCutoffInHz;
+    return this->m_rpcSettings.imuFilterCutoffInHz;
 }
 
 bool WholeBodyDynamicsDevice::set_imuFilterCutoffInHz(const double newCutoff)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    this->settings.imuFilterCutoffInHz = newCutoff;
+    this->m_rpcSettings.imuFilterCutoffInHz = newCutoff;
+    m_settingsMailbox.publish(m_rpcSettings);
 
     return true;
 }
 
 bool WholeBodyDynamicsDevice::useFixedFrameAsKinematicSource(const std::string& fixedFrame)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
     iDynTree::FrameIndex fixedFrameIndex = estimator.model().getFrameIndex(fixedFrame);
 
@@ -1898,49 +2085,73 @@ bool WholeBodyDynamicsDevice::useFixedFrameAsKinematicSource(const std::string&
     }
 
     // Set the kinematic source to a fixed frame
-    settings.kinematicSource = FIXED_FRAME;
-    settings.fixedFrameName = fixedFrame;
+    m_rpcSettings.kinematicSource = FIXED_FRAME;
+    m_rpcSettings.fixedFrameName = fixedFrame;
+    m_settingsMailbox.publish(m_rpcSettings);
 
     yInfo() << "wholeBodyDynamics : successfully set the kinematic source to be the fixed frame " << fixedFrame;
-    yInfo() << "wholeBodyDynamics : with gravity " << settings.fixedFrameGravity.toString();
+    yInfo() << "wholeBodyDynamics : with gravity " << m_rpcSettings.fixedFrameGravity.toString();
 
     return true;
 }
 
 bool WholeBodyDynamicsDevice::useIMUAsKinematicSource()
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
     yInfo() << "wholeBodyDynamics : successfully set the kinematic source to be the IMU ";
 
-    settings.kinematicSource = IMU;
+    m_rpcSettings.kinematicSource = IMU;
+    m_settingsMailbox.publish(m_rpcSettings);
 
     return true;
 }
 
 bool WholeBodyDynamicsDevice::setUseOfJointVelocities(const bool enable)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    this->settings.useJointVelocity = enable;
+    this->m_rpcSettings.useJointVelocity = enable;
+    m_settingsMailbox.publish(m_rpcSettings);
 
     return true;
 }
 
 bool WholeBodyDynamicsDevice::setUseOfJointAccelerations(const bool enable)
 {
-    yarp::os::LockGuard guard(this->deviceMutex);
+    yarp::os::LockGuard guard(this->m_rpcMutex);
 
-    this->settings.useJointAcceleration = enable;
+    this->m_rpcSettings.useJointAcceleration = enable;
+    m_settingsMailbox.publish(m_rpcSettings);
 
     return true;
 }
 
 std::string WholeBodyDynamicsDevice::getCurrentSettingsString()
 {
-   yarp::os::LockGuard guard(this->deviceMutex);
+   yarp::os::LockGuard guard(this->m_rpcMutex);
+
+   return m_rpcSettings.toString();
+}
+
+std::string WholeBodyDynamicsDevice::getPipelineTimingStatisticsString()
+{
+    yarp::os::LockGuard guard(this->m_rpcMutex);
+
+    m_timingStatisticsMailbox.fetch(m_rpcTimingRecorder);
+
+    return m_rpcTimingRecorder.getStatisticsString();
+}
+
+bool WholeBodyDynamicsDevice::resetPipelineTimingStatistics()
+{
+    wholeBodyDynamicsCommand command;
+    command.type = RESET_TIMING_STATISTICS_COMMAND;
+    command.firstFrame = iDynTree::FRAME_INVALID_INDEX;
+    command.secondFrame = iDynTree::FRAME_INVALID_INDEX;
+    command.nrOfSamples = 0;
 
-   return settings.toString();
+    return pushRPCCommand(command);
 }
 
 bool WholeBodyDynamicsDevice::resetSimpleLeggedOdometry(const std::string& /*initial_world_frame*/, const std::string& /*initial_fixed_link*/)
@@ -1976,11 +2187,9 @@ void WholeBodyDynamicsDevice::endCalibration()
 
 wholeBodyDynamicsDeviceFilters::wholeBodyDynamicsDeviceFilters(): imuLinearAccelerationFilter(0),
                                                                   imuAngularVelocityFilter(0),
-                                                                  forcetorqueFilters(0),
                                                                   jntVelFilter(0),
                                                                   jntAccFilter(0),
                                                                   bufferYarp3(0),
-                                                                  bufferYarp6(0),
                                                                   bufferYarpDofs(0)
 {
 
@@ -1996,7 +2205,6 @@ void wholeBodyDynamicsDeviceFilters::init(int nrOfFTSensors,
 {
     // Allocate buffers
     bufferYarp3.resize(3,0.0);
-    bufferYarp6.resize(6,0.0);
     bufferYarpDofs.resize(nrOfDOFsProcessed,0.0);
 
     imuLinearAccelerationFilter =
@@ -2004,12 +2212,7 @@ void wholeBodyDynamicsDeviceFilters::init(int nrOfFTSensors,
     imuAngularVelocityFilter =
         new iCub::ctrl::realTime::FirstOrderLowPassFilter(initialCutOffForIMUInHz,periodInSeconds,bufferYarp3);
 
-    forcetorqueFilters.resize(nrOfFTSensors);
-    for(int ft_numeric = 0; ft_numeric < nrOfFTSensors; ft_numeric++ )
-    {
-        forcetorqueFilters[ft_numeric] =
-                new iCub::ctrl::realTime::FirstOrderLowPassFilter(initialCutOffForFTInHz,periodInSeconds,bufferYarp6);
-    }
+    forcetorqueFilters.init(nrOfFTSensors,initialCutOffForFTInHz,periodInSeconds);
 
     jntVelFilter =
         new iCub::ctrl::realTime::FirstOrderLowPassFilter(initialCutOffForJointVelInHz,periodInSeconds,bufferYarpDofs);
@@ -2026,10 +2229,7 @@ void wholeBodyDynamicsDeviceFilters::updateCutOffFrequency(double cutoffForFTInH
     imuLinearAccelerationFilter->setCutFrequency(cutOffForIMUInHz);
     imuAngularVelocityFilter->setCutFrequency(cutOffForIMUInHz);
 
-    for(size_t ft_numeric = 0; ft_numeric < forcetorqueFilters.size(); ft_numeric++ )
-    {
-        forcetorqueFilters[ft_numeric]->setCutFrequency(cutoffForFTInHz);
-    }
+    forcetorqueFilters.setCutFrequency(cutoffForFTInHz);
 
     jntVelFilter->setCutFrequency(cutOffForJointVelInHz);
     jntAccFilter->setCutFrequency(cutOffForJointAccInHz);
@@ -2049,14 +2249,6 @@ void wholeBodyDynamicsDeviceFilters::fini()
         imuAngularVelocityFilter = 0;
     }
 
-    for(size_t ft_numeric = 0; ft_numeric < forcetorqueFilters.size(); ft_numeric++ )
-    {
-        delete forcetorqueFilters[ft_numeric];
-        forcetorqueFilters[ft_numeric] = 0;
-    }
-
-    forcetorqueFilters.resize(0);
-
     if( jntVelFilter )
     {
         delete jntVelFilter;
@@ -24,10 +24,15 @@
 // Filters
 #include "ctrlLibRT/filters.h"
 
+// Timing
+#include "ctrlLibRT/timing.h"
+
 #include <wholeBodyDynamicsSettings.h>
 #include <wholeBodyDynamics_IDLServer.h>
 #include "SixAxisForceTorqueMeasureHelpers.h"
 #include "GravityCompensationHelpers.h"
+#include "SensorsAcquisitionHelpers.h"
+#include "RPCHandoffHelpers.h"
 
 #include <vector>
 
@@ -53,6 +58,41 @@ struct outputWrenchPortInformation
     yarp::os::BufferedPort<yarp::sig::Vector> * output_port;
 };
 
+/**
+ * Type of the commands sent by the RPC thread to the estimation thread.
+ */
+enum wholeBodyDynamicsCommandType
+{
+    START_CALIBRATION_COMMAND,
+    RESET_OFFSET_COMMAND,
+    RESET_TIMING_STATISTICS_COMMAND
+};
+
+/**
+ * Command sent by the RPC thread to the estimation thread.
+ *
+ * The frames are already validated by the RPC thread, so that no string
+ * is copied in the estimation thread.
+ */
+struct wholeBodyDynamicsCommand
+{
+    wholeBodyDynamicsCommandType type;
+
+    /**
+     * Frames at which the external wrenches are assumed to be applied
+     * during the calibration (secondFrame is iDynTree::FRAME_INVALID_INDEX
+     * if only one frame is used).
+     */
+    iDynTree::FrameIndex firstFrame;
+    iDynTree::FrameIndex secondFrame;
+    int32_t nrOfSamples;
+};
+
+/**
+ * Maximum number of commands waiting to be processed by the estimation thread.
+ */
+const int wholeBodyDynamics_commandsQueueCapacity = 16;
+
 
 class wholeBodyDynamicsDeviceFilters
 {
@@ -89,8 +129,8 @@ class wholeBodyDynamicsDeviceFilters
     ///< low pass filters for IMU angular velocity
     iCub::ctrl::realTime::FirstOrderLowPassFilter * imuAngularVelocityFilter;
 
-    ///< low pass filters for ForceTorque sensors
-    std::vector<iCub::ctrl::realTime::FirstOrderLowPassFilter *> forcetorqueFilters;
+    ///< low pass filters for ForceTorque sensors, all the sensors are filtered in one pass
+    wholeBodyDynamics::SixAxisForceTorqueFilterBank forcetorqueFilters;
 
     ///< low pass filter for Joint velocities
     iCub::ctrl::realTime::FirstOrderLowPassFilter * jntVelFilter;
@@ -101,9 +141,6 @@ class wholeBodyDynamicsDeviceFilters
     ///< Yarp vector buffer of dimension 3
     yarp::sig::Vector bufferYarp3;
 
-    ///< Yarp vector buffer of dimension 6
-    yarp::sig::Vector bufferYarp6;
-
     ///< Yarp vector buffer of dimension dofs
     yarp::sig::Vector bufferYarpDofs;
 };
@@ -124,6 +161,8 @@ class wholeBodyDynamicsDeviceFilters
  * | forceTorqueFilterCutoffInHz | - | double            | Hz    |      -        | Yes      | Cutoff frequency of the filter used to filter FT measures.  |  The used filter is a simple first order filter. |
  * | jointVelFilterCutoffInHz    | - | double            | Hz    |      -        | Yes      | Cutoff frequency of the filter used to filter joint velocities measures. | The used filter is a simple first order filter. |
  * | jointAccFilterCutoffInHz    | - | double            | Hz    |      -        | Yes      | Cutoff frequency of the filter used to filter joint accelerations measures. | The used filter is a simple first order filter. |
+ * | useSensorsAcquisitionThread | - | bool              | -     |    false      | No       | If true, the sensors are read in a separate thread, and the estimation uses the latest available sensors snapshot without blocking on the sensor reads. | The acquisition thread runs at the same period of the estimation. If the latest snapshot is older than five periods, a warning is printed and the sensors are considered not read correctly. |
+ * | coalesceVirtualAnalogSensorsUpdates | - | bool  | -     |    false      | No       | If true, the estimated torques are published with a single updateMeasure call for each virtual analog sensor, also if only some of its axes are estimated. | The axes that are not estimated are overwritten with zero at every cycle. |
  * | defaultContactFrames      | -   | vector of strings (name of frames ) |-| - |  Yes     | Vector of default contact frames. If no external force read from the skin is found on a given submodel, the defaultContactFrames list is scanned and the first frame found on the submodel is the one at which origin the unknown contact force is assumed to be. | - |
  * | alwaysUpdateAllVirtualTorqueSensors | -     |  bool |  -    |      -        |  Yes     | Enforce that a virtual sensor for each estimated axes is available. | Tipically this is set to false when the device is running in the robot, while to true if it is running outside the robot. |
  * | defaultContactFrames |      -   | vector of strings |  -    |    -          | Yes      | If not data is read from the skin, specify the location of the default contacts | For each submodel induced by the FT sensor, the first not used frame that belongs to that submodel is selected from the list. An error is raised if not suitable frame is found for a submodel. |
@@ -139,6 +178,7 @@ class wholeBodyDynamicsDeviceFilters
  * |                      | enableGravityCompensation | bool | -  | -           | No        |  |  |
  * |                      | gravityCompensationBaseLink| string | - | -         | No        | ..  | |
  * |                      | gravityCompensationAxesNames | vector of strings | - | - | No   | Axes for which the gravity compensation is published. | |
+ * |                      | modesRefreshPeriodInMs | int | ms | 100       | No        | Period with which the control and interaction modes of the gravity compensated axes are read. | The impedance offsets are sent by a separate thread, using the last read modes. |
  *
  * The axes contained in the axesNames parameter are then mapped to the wrapped controlboard in the attachAll method, using controlBoardRemapper class.
  * Furthermore are also used to match the yarp axes to the joint names found in the passed URDF file.
@@ -339,13 +379,15 @@ private:
      * a YARP RPC port.
      */
     wholeBodyDynamicsSettings settings;
-    wholeBodyDynamicsSettings::Editor settingsEditor;
 
     /**
-     * Mutex to protect the settings data structure, and all the data in
-     * the class that is accessed by the run method, the attachAll methods
-     * (managed by the yarprobotinterface thread) and by the RPC call
-     * invoked by the RPC thread.
+     * Mutex to protect all the data in the class that is accessed
+     * by the run method and by the open, attachAll and detachAll methods
+     * (managed by the yarprobotinterface thread).
+     *
+     * The RPC and settings ports never take this mutex: they modify
+     * m_rpcSettings and send commands to the estimation thread, that
+     * processes them at the beginning of each cycle (see processRPCCommands).
      */
     yarp::os::Mutex deviceMutex;
 
@@ -423,14 +465,19 @@ private:
     /**
      * Return true if we were able to read the sensors and update
      * the internal buffers, false otherwise.
+     * Used only to check the sensors when attaching them: at run time
+     * the sensors are read by m_sensorsAcquisition.
      */
     bool readFTSensors(bool verbose=true);
 
     /**
      * Return true if we were able to read the sensors and update
      * the internal buffers, false otherwise.
+     * Used only to check the sensors when attaching them: at run time
+     * the sensors are read by m_sensorsAcquisition.
      */
     bool readIMUSensors(bool verbose=true);
+    void processRPCCommands();
     void readSensors();
     void filterSensorsAndRemoveSensorOffsets();
     void updateKinematics();
@@ -659,10 +706,30 @@ private:
        * @return the current settings as a human readable string.
        */
       virtual std::string getCurrentSettingsString();
+      /**
+       * Get the latency statistics (50th percentile, 99th percentile and maximum) of each stage
+       * of the estimation loop, and the number of overruns of the loop period.
+       * The statistics are updated approximately once per second.
+       * @return the timing statistics as a human readable string.
+       */
+      virtual std::string getPipelineTimingStatisticsString();
+      /**
+       * Reset the latency statistics of the estimation loop.
+       * @return true/false on success/failure
+       */
+      virtual bool resetPipelineTimingStatistics();
 
     void setupCalibrationCommonPart(const int32_t nrOfSamples);
     bool setupCalibrationWithExternalWrenchOnOneFrame(const std::string & frameName, const int32_t nrOfSamples);
     bool setupCalibrationWithExternalWrenchesOnTwoFrames(const std::string & frame1Name, const std::string & frame2Name, const int32_t nrOfSamples);
+    bool setupCalibrationWithExternalWrenchesOnFrames(const iDynTree::FrameIndex firstFrame, const iDynTree::FrameIndex secondFrame, const int32_t nrOfSamples);
+
+    /**
+     * Send a command to the estimation thread to start a calibration, assuming that the
+     * external wrenches are applied on the frame firstFrameName (and on secondFrameName, if not empty).
+     */
+    bool requestCalibration(const std::string & firstFrameName, const std::string & secondFrameName, const int32_t nrOfSamples);
+    bool pushRPCCommand(const wholeBodyDynamicsCommand & command);
 
      /**
       * RPC Calibration related attributes
@@ -730,7 +797,8 @@ private:
      */
     iDynTree::LinkNetExternalWrenches netExternalWrenchesExertedByTheEnviroment;
 
-    // Class for computing relative transforms (useful for net external wrench frame computations and gravity compensation)
+    // Class for computing relative transforms (useful for net external wrench frame computations and gravity compensation),
+    // its state is set once for each cycle in updateKinematics
     iDynTree::KinDynComputations kinDynComp;
 
     // Attributes for gravity compensation
@@ -738,8 +806,47 @@ private:
     wholeBodyDynamics::GravityCompensationHelper m_gravCompHelper;
     std::vector<size_t> m_gravityCompesationJoints;
     iDynTree::JointDOFsDoubleArray m_gravityCompensationTorques;
+    int m_gravityCompensationModesRefreshPeriodInMs;
+    wholeBodyDynamics::GravityCompensationOffsetsPublisher m_gravCompOffsetsPublisher;
     void resetGravityCompensation();
 
+    // Attributes for the sensors acquisition
+    bool m_useSensorsAcquisitionThread;
+    wholeBodyDynamics::SensorsAcquisitionThread m_sensorsAcquisition;
+    bool m_sensorsSnapshotTooOld;
+    iDynTree::Wrench m_bufferWrench;
+
+    // Attributes for the timing of the stages of the run method
+    iCub::ctrl::realTime::PipelineTimingRecorder m_timingRecorder;
+    yarp::sig::Vector m_timingStatistics;
+    yarp::os::BufferedPort<yarp::sig::Vector> m_timingStatisticsPort;
+    size_t m_timingPublishingDecimation;
+    size_t m_cyclesSinceLastTimingPublishing;
+    bool openTimingStatisticsPort();
+    bool closeTimingStatisticsPort();
+    void initTimingRecorder();
+    void publishTimingStatistics();
+
+    // Attributes for the handoff of the settings and commands from the RPC threads to the estimation thread
+    /**
+     * Copy of the settings modified by the RPC and settings ports, protected by m_rpcMutex.
+     * Each modification is published in m_settingsMailbox, from which the estimation thread
+     * copies it in settings.
+     */
+    wholeBodyDynamicsSettings m_rpcSettings;
+    yarp::os::Mutex m_rpcMutex;
+    wholeBodyDynamics::LatestValueMailbox<wholeBodyDynamicsSettings> m_settingsMailbox;
+    wholeBodyDynamics::SettingsEditorHandoff m_settingsEditor;
+    wholeBodyDynamics::CommandsQueue<wholeBodyDynamicsCommand,wholeBodyDynamics_commandsQueueCapacity> m_commandsQueue;
+    wholeBodyDynamicsCommand m_commandsBuffer[wholeBodyDynamics_commandsQueueCapacity];
+
+    /**
+     * Copy of m_timingRecorder periodically published by the estimation thread
+     * in m_timingStatisticsMailbox, and read by the RPC thread.
+     */
+    wholeBodyDynamics::LatestValueMailbox<iCub::ctrl::realTime::PipelineTimingRecorder> m_timingStatisticsMailbox;
+    iCub::ctrl::realTime::PipelineTimingRecorder m_rpcTimingRecorder;
+
 public:
     // CONSTRUCTOR
     WholeBodyDynamicsDevice();
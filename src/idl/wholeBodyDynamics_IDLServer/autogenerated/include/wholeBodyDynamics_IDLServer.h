@@ -143,6 +143,17 @@ public:
    * @return the current settings as a human readable string.
    */
   virtual std::string getCurrentSettingsString();
+  /**
+   * Get the latency statistics (50th percentile, 99th percentile and maximum) of each stage
+   * of the estimation loop, and the number of overruns of the loop period.
+   * @return the timing statistics as a human readable string.
+   */
+  virtual std::string getPipelineTimingStatisticsString();
+  /**
+   * Reset the latency statistics of the estimation loop.
+   * @return true/false on success/failure
+   */
+  virtual bool resetPipelineTimingStatistics();
   virtual bool read(yarp::os::ConnectionReader& connection);
   virtual std::vector<std::string> help(const std::string& functionName="--all");
 };
@@ -193,6 +193,22 @@ public:
   virtual bool read(yarp::os::ConnectionReader& connection);
 };
 
+class wholeBodyDynamics_IDLServer_getPipelineTimingStatisticsString : public yarp::os::Portable {
+public:
+  std::string _return;
+  void init();
+  virtual bool write(yarp::os::ConnectionWriter& connection);
+  virtual bool read(yarp::os::ConnectionReader& connection);
+};
+
+class wholeBodyDynamics_IDLServer_resetPipelineTimingStatistics : public yarp::os::Portable {
+public:
+  bool _return;
+  void init();
+  virtual bool write(yarp::os::ConnectionWriter& connection);
+  virtual bool read(yarp::os::ConnectionReader& connection);
+};
+
 bool wholeBodyDynamics_IDLServer_calib::write(yarp::os::ConnectionWriter& connection) {
   yarp::os::idl::WireWriter writer(connection);
   if (!writer.writeListHeader(3)) return false;
@@ -672,6 +688,48 @@ void wholeBodyDynamics_IDLServer_getCurrentSettingsString::init() {
   _return = "";
 }
 
+bool wholeBodyDynamics_IDLServer_getPipelineTimingStatisticsString::write(yarp::os::ConnectionWriter& connection) {
+  yarp::os::idl::WireWriter writer(connection);
+  if (!writer.writeListHeader(1)) return false;
+  if (!writer.writeTag("getPipelineTimingStatisticsString",1,1)) return false;
+  return true;
+}
+
+bool wholeBodyDynamics_IDLServer_getPipelineTimingStatisticsString::read(yarp::os::ConnectionReader& connection) {
+  yarp::os::idl::WireReader reader(connection);
+  if (!reader.readListReturn()) return false;
+  if (!reader.readString(_return)) {
+    reader.fail();
+    return false;
+  }
+  return true;
+}
+
+void wholeBodyDynamics_IDLServer_getPipelineTimingStatisticsString::init() {
+  _return = "";
+}
+
+bool wholeBodyDynamics_IDLServer_resetPipelineTimingStatistics::write(yarp::os::ConnectionWriter& connection) {
+  yarp::os::idl::WireWriter writer(connection);
+  if (!writer.writeListHeader(1)) return false;
+  if (!writer.writeTag("resetPipelineTimingStatistics",1,1)) return false;
+  return true;
+}
+
+bool wholeBodyDynamics_IDLServer_resetPipelineTimingStatistics::read(yarp::os::ConnectionReader& connection) {
+  yarp::os::idl::WireReader reader(connection);
+  if (!reader.readListReturn()) return false;
+  if (!reader.readBool(_return)) {
+    reader.fail();
+    return false;
+  }
+  return true;
+}
+
+void wholeBodyDynamics_IDLServer_resetPipelineTimingStatistics::init() {
+  _return = false;
+}
+
 wholeBodyDynamics_IDLServer::wholeBodyDynamics_IDLServer() {
   yarp().setOwner(*this);
 }
@@ -885,6 +943,26 @@ std::string wholeBodyDynamics_IDLServer::getCurrentSettingsString() {
   bool ok = yarp().write(helper,helper);
   return ok?helper._return:_return;
 }
+std::string wholeBodyDynamics_IDLServer::getPipelineTimingStatisticsString() {
+  std::string _return = "";
+  wholeBodyDynamics_IDLServer_getPipelineTimingStatisticsString helper;
+  helper.init();
+  if (!yarp().canWrite()) {
+    yError("Missing server method '%s'?","std::string wholeBodyDynamics_IDLServer::getPipelineTimingStatisticsString()");
+  }
+  bool ok = yarp().write(helper,helper);
+  return ok?helper._return:_return;
+}
+bool wholeBodyDynamics_IDLServer::resetPipelineTimingStatistics() {
+  bool _return = false;
+  wholeBodyDynamics_IDLServer_resetPipelineTimingStatistics helper;
+  helper.init();
+  if (!yarp().canWrite()) {
+    yError("Missing server method '%s'?","bool wholeBodyDynamics_IDLServer::resetPipelineTimingStatistics()");
+  }
+  bool ok = yarp().write(helper,helper);
+  return ok?helper._return:_return;
+}
 
 bool wholeBodyDynamics_IDLServer::read(yarp::os::ConnectionReader& connection) {
   yarp::os::idl::WireReader reader(connection);
@@ -1217,6 +1295,28 @@ bool wholeBodyDynamics_IDLServer::read(yarp::os::ConnectionReader& connection) {
       reader.accept();
       return true;
     }
+    if (tag == "getPipelineTimingStatisticsString") {
+      std::string _return;
+      _return = getPipelineTimingStatisticsString();
+      yarp::os::idl::WireWriter writer(reader);
+      if (!writer.isNull()) {
+        if (!writer.writeListHeader(1)) return false;
+        if (!writer.writeString(_return)) return false;
+      }
+      reader.accept();
+      return true;
+    }
+    if (tag == "resetPipelineTimingStatistics") {
+      bool _return;
+      _return = resetPipelineTimingStatistics();
+      yarp::os::idl::WireWriter writer(reader);
+      if (!writer.isNull()) {
+        if (!writer.writeListHeader(1)) return false;
+        if (!writer.writeBool(_return)) return false;
+      }
+      reader.accept();
+      return true;
+    }
     if (tag == "help") {
       std::string functionName;
       if (!reader.readString(functionName)) {
@@ -1272,6 +1372,8 @@ std::vector<std::string> wholeBodyDynamics_IDLServer::help(const std::string& fu
     helpString.push_back("setUseOfJointVelocities");
     helpString.push_back("setUseOfJointAccelerations");
     helpString.push_back("getCurrentSettingsString");
+    helpString.push_back("getPipelineTimingStatisticsString");
+    helpString.push_back("resetPipelineTimingStatistics");
     helpString.push_back("help");
   }
   else {
@@ -1401,6 +1503,17 @@ std::vector<std::string> wholeBodyDynamics_IDLServer::help(const std::string& fu
       helpString.push_back("Get the current settings in the form of a string. ");
       helpString.push_back("@return the current settings as a human readable string. ");
     }
+    if (functionName=="getPipelineTimingStatisticsString") {
+      helpString.push_back("std::string getPipelineTimingStatisticsString() ");
+      helpString.push_back("Get the latency statistics (50th percentile, 99th percentile and maximum) of each stage ");
+      helpString.push_back("of the estimation loop, and the number of overruns of the loop period. ");
+      helpString.push_back("@return the timing statistics as a human readable string. ");
+    }
+    if (functionName=="resetPipelineTimingStatistics") {
+      helpString.push_back("bool resetPipelineTimingStatistics() ");
+      helpString.push_back("Reset the latency statistics of the estimation loop. ");
+      helpString.push_back("@return true/false on success/failure ");
+    }
     if (functionName=="help") {
       helpString.push_back("std::vector<std::string> help(const std::string& functionName=\"--all\")");
       helpString.push_back("Return list of available commands, or help message for a specific function");
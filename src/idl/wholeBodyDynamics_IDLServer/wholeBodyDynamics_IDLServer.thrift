@@ -159,8 +159,17 @@ service wholeBodyDynamics_IDLServer
    * @return the current settings as a human readable string.
    */
   string getCurrentSettingsString();
-}
-
-
 
+  /**
+  * Get the latency statistics (50th percentile, 99th percentile and maximum) of each stage
+  * of the estimation loop, and the number of overruns of the loop period.
+  * @return the timing statistics as a human readable string.
+  */
+  string getPipelineTimingStatisticsString();
 
+  /**
+  * Reset the latency statistics of the estimation loop.
+  * @return true/false on success/failure
+  */
+  bool resetPipelineTimingStatistics();
+}
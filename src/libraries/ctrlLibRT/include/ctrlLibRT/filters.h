@@ -32,6 +32,8 @@
 
 #include<Eigen/Dense>
 
+#include <cmath>
+
 #include <yarp/sig/Vector.h>
 
 
@@ -147,17 +149,221 @@ public:
 
 
 
+/**
+* \ingroup Filters
+*
+* IIR filter with compile-time order and (optionally) compile-time
+* number of channels.
+*
+* Differently from Filter, all the storage is sized at construction
+* (or at compile time if Channels is not Eigen::Dynamic), the past
+* samples are kept in a shift register instead of a ring buffer indexed
+* with modulo arithmetic, and no memory is allocated in filt().
+*
+* The filter implements the same difference equation of Filter:
+* a[0]*y(k) = sum_i b[i]*u(k-i) - sum_{i>0} a[i]*y(k-i)
+*
+* @tparam Order order of the filter (number of past samples kept), shall be >= 1.
+* @tparam Channels number of filtered signals, or Eigen::Dynamic.
+*/
+template<int Order, int Channels>
+class FixedOrderFilter
+{
+public:
+    typedef Eigen::Matrix<double,Order+1,1> Coeffs;
+    typedef Eigen::Matrix<double,Channels,1> Signal;
+
+protected:
+    Coeffs b;
+    Coeffs a;
+    Signal y;
+
+    Eigen::Matrix<double,Channels,Order> uold; ///< Past inputs: column i is the input of i+1 samples ago
+    Eigen::Matrix<double,Channels,Order> yold; ///< Past outputs: column i is the output of i+1 samples ago
+
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    /**
+    * Creates a pass-through filter (b = a = [1 0 ... 0]) with zero state.
+    * @param nrOfChannels number of filtered signals, used only if Channels is Eigen::Dynamic.
+    */
+    explicit FixedOrderFilter(const int nrOfChannels=Channels):
+        b(Coeffs::Zero()), a(Coeffs::Zero()),
+        y(Signal::Zero(nrOfChannels)),
+        uold(nrOfChannels,Order), yold(nrOfChannels,Order)
+    {
+        b[0]=1.0;
+        a[0]=1.0;
+        uold.setZero();
+        yold.setZero();
+    }
+
+    /**
+    * Creates a filter with specified numerator and denominator
+    * coefficients.
+    * @param num numerator coefficients given as increasing power of z^-1.
+    * @param den denominator coefficients given as increasing power of z^-1.
+    * @param y0 initial output.
+    * @note den[0] shall not be 0.
+    */
+    template<typename Derived>
+    FixedOrderFilter(const Coeffs &num, const Coeffs &den,
+                     const Eigen::MatrixBase<Derived> &y0):
+        b(num), a(den), y(y0),
+        uold(y0.size(),Order), yold(y0.size(),Order)
+    {
+        init(y0);
+    }
+
+    /**
+    * Internal state reset.
+    * @param y0 new internal state.
+    */
+    template<typename Derived>
+    void init(const Eigen::MatrixBase<Derived> &y0)
+    {
+        init(y0,Signal::Zero(y0.size()));
+    }
+
+    /**
+    * Internal state reset for filter with zero gain.
+    * @param y0 new internal state.
+    * @param u0 expected next input.
+    * @note see Filter::init .
+    */
+    template<typename DerivedY, typename DerivedU>
+    void init(const Eigen::MatrixBase<DerivedY> &y0, const Eigen::MatrixBase<DerivedU> &u0)
+    {
+        y=y0;
+
+        const double sum_b=b.sum();
+        const double sum_a=a.sum();
+
+        if (std::fabs(sum_b)>1e-9)   // if filter DC gain is not zero
+        {
+            for (int i=0; i<Order; i++)
+            {
+                uold.col(i)=(sum_a/sum_b)*y;
+                yold.col(i)=y;
+            }
+        }
+        else
+        {
+            // if filter gain is zero then you need to know in advance what
+            // the next input is going to be for initializing (that is u0)
+            // if sum_a==a[0] then the filter can only be initialized to zero
+            const double y_scale=(std::fabs(sum_a-a[0])>1e-9)?a[0]/(a[0]-sum_a):1.0;
+            for (int i=0; i<Order; i++)
+            {
+                uold.col(i)=u0;
+                yold.col(i)=y_scale*y;
+            }
+        }
+    }
+
+    /**
+    * Returns the current filter coefficients.
+    */
+    void getCoeffs(Coeffs &num, Coeffs &den) const
+    {
+        num=b;
+        den=a;
+    }
+
+    /**
+    * Sets new filter coefficients.
+    * @note the internal state is reinitialized to the current output.
+    */
+    void setCoeffs(const Coeffs &num, const Coeffs &den)
+    {
+        b=num;
+        a=den;
+        init(y);
+    }
+
+    /**
+    * Modifies the filter coefficients without touching the internal state.
+    * @note den[0] shall not be 0.
+    */
+    void adjustCoeffs(const Coeffs &num, const Coeffs &den)
+    {
+        b=num;
+        a=den;
+    }
+
+    /**
+    * Performs filtering on the actual input.
+    * @param u the actual input.
+    * @return a reference the corresponding output.
+    * @note the returned reference is valid till any new call to filt.
+    */
+    template<typename Derived>
+    const Signal & filt(const Eigen::MatrixBase<Derived> &u)
+    {
+        y=b[0]*u;
+
+        for (int i=0; i<Order; i++)
+        {
+            y+=b[i+1]*uold.col(i);
+        }
+
+        for (int i=0; i<Order; i++)
+        {
+            y-=a[i+1]*yold.col(i);
+        }
+
+        y*=(1.0/a[0]);
+
+        for (int i=Order-1; i>0; i--)
+        {
+            uold.col(i)=uold.col(i-1);
+            yold.col(i)=yold.col(i-1);
+        }
+        uold.col(0)=u;
+        yold.col(0)=y;
+
+        return y;
+    }
+
+    /**
+    * Return the reference to the current filter output.
+    */
+    const Signal & output() const { return y; }
+
+    /**
+    * Return the number of filtered channels.
+    */
+    int getNrOfChannels() const { return y.size(); }
+};
+
+/**
+* Compute the coefficients of the discrete-time (Tustin) first order low
+* pass filter H(s) = \frac{1}{1+\tau s} .
+* @param cutFrequency cut frequency (Hz).
+* @param sampleTime sample time (s).
+* @param num the numerator coefficients, as increasing power of z^-1.
+* @param den the denominator coefficients, as increasing power of z^-1.
+*/
+void computeFirstOrderLowPassCoeffs(const double cutFrequency, const double sampleTime,
+                                    Eigen::Vector2d &num, Eigen::Vector2d &den);
+
+
 /**
 * \ingroup Filters
 *
 * First order low pass filter implementing the transfer function
 * H(s) = \frac{1}{1+\tau s}
 *
+* This class is a thin adapter over FixedOrderFilter<1,Eigen::Dynamic>:
+* the storage is allocated at construction and filt() does not allocate
+* memory.
+*
 */
 class FirstOrderLowPassFilter
 {
 protected:
-    Filter *filter;         // low pass filter
+    FixedOrderFilter<1,Eigen::Dynamic> filter; // low pass filter
     double fc;              // cut frequency
     double Ts;              // sample time
     yarp::sig::Vector y;    // filter current output
@@ -165,6 +371,8 @@ protected:
     void computeCoeff();
 
 public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
     /**
     * Creates a filter with specified parameters
     * @param cutFrequency cut frequency (Hz).
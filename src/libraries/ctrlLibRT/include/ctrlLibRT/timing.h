@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2016 Fondazione Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+/**
+ * \defgroup Timing Timing
+ *
+ * @ingroup ctrlLibRT
+ *
+ * Classes for measuring the latency of the stages of a periodic loop,
+ * without allocating memory or taking locks while recording.
+ *
+ */
+
+#ifndef RT_TIMING_H
+#define RT_TIMING_H
+
+#include <yarp/sig/Vector.h>
+
+#include <string>
+#include <vector>
+
+namespace iCub
+{
+
+namespace ctrl
+{
+
+namespace realTime
+{
+
+/**
+* \ingroup Timing
+*
+* Latency histogram with logarithmic buckets (in the spirit of HDR histograms).
+*
+* The range [lowestTrackableValue, lowestTrackableValue*2^nrOfOctaves] is divided
+* in nrOfOctaves octaves, each one divided in subBucketsPerOctave linear buckets,
+* so that the relative error of the returned percentiles is bounded by
+* 1/subBucketsPerOctave. Values outside the range are saturated to the first
+* or the last bucket, while the maximum is always tracked exactly.
+*
+* All the memory is allocated in the constructor: record() is O(1) and
+* does not allocate.
+*/
+class LatencyHistogram
+{
+protected:
+    std::vector<unsigned long> buckets;
+    double lowest;
+    int octaves;
+    int subBuckets;
+
+    unsigned long count;
+    double sum;
+    double max;
+
+    double getBucketUpperBound(const size_t bucket) const;
+
+public:
+    /**
+    * Create an empty histogram.
+    * @param lowestTrackableValue lowest value (s) that is distinguished from zero.
+    * @param nrOfOctaves number of powers of two covered by the histogram.
+    * @param subBucketsPerOctave number of linear buckets in each octave.
+    */
+    LatencyHistogram(const double lowestTrackableValue=1e-6,
+                     const int nrOfOctaves=24,
+                     const int subBucketsPerOctave=16);
+
+    /**
+    * Add a sample to the histogram.
+    * @param value the measured latency (s).
+    */
+    void record(const double value);
+
+    /**
+    * Remove all the samples from the histogram.
+    */
+    void reset();
+
+    /**
+    * Get the value below which the given percentage of samples fall.
+    * @param percentile the percentile, in [0,100].
+    * @return the percentile (s), or 0 if no sample was recorded.
+    */
+    double getPercentile(const double percentile) const;
+
+    /**
+    * Return the number of recorded samples.
+    */
+    unsigned long getCount() const { return count; }
+
+    /**
+    * Return the maximum recorded sample (s).
+    */
+    double getMax() const { return max; }
+
+    /**
+    * Return the mean of the recorded samples (s).
+    */
+    double getMean() const { return (count>0)?(sum/count):0.0; }
+};
+
+/**
+* \ingroup Timing
+*
+* Recorder of the duration of the sequential stages of a periodic loop.
+*
+* The loop calls startCycle() at its beginning, endStage(i) at the end of the i-th
+* stage and endCycle() at its end. For each stage and for the whole cycle a
+* LatencyHistogram is kept, and the cycles whose duration exceeds the expected
+* period are counted as overruns.
+*
+* The recorder does not take any lock: it is meant to be written by the periodic
+* thread and read (for example by an RPC handler) under the same mutex that already
+* protects the loop.
+*/
+class PipelineTimingRecorder
+{
+protected:
+    std::vector<std::string> stageNames;
+    std::vector<LatencyHistogram> stageHistograms;
+    std::vector<double> lastStageDurations;
+    LatencyHistogram cycleHistogram;
+
+    double period;
+    unsigned long nrOfOverruns;
+
+    double cycleStartTime;
+    double stageStartTime;
+
+public:
+    PipelineTimingRecorder();
+
+    /**
+    * Allocate the histograms and reset the statistics.
+    * @param names the names of the stages of the loop.
+    * @param periodInSeconds the expected period of the loop (s).
+    */
+    void init(const std::vector<std::string> &names, const double periodInSeconds);
+
+    /**
+    * Reset the statistics.
+    */
+    void reset();
+
+    /**
+    * Mark the beginning of a cycle (and of its first stage).
+    */
+    void startCycle();
+
+    /**
+    * Mark the end of a stage (and the beginning of the following one).
+    * @param stage the index of the stage, as in the vector passed to init.
+    */
+    void endStage(const size_t stage);
+
+    /**
+    * Mark the end of a cycle.
+    */
+    void endCycle();
+
+    /**
+    * Return the number of stages.
+    */
+    size_t getNrOfStages() const { return stageNames.size(); }
+
+    /**
+    * Return the number of recorded cycles.
+    */
+    unsigned long getNrOfCycles() const { return cycleHistogram.getCount(); }
+
+    /**
+    * Return the number of cycles that lasted more than the expected period.
+    */
+    unsigned long getNrOfOverruns() const { return nrOfOverruns; }
+
+    /**
+    * Get the statistics as a flat vector.
+    *
+    * The vector contains, for each stage and then for the whole cycle, the
+    * last duration, the 50th percentile, the 99th percentile and the maximum (s),
+    * followed by the number of cycles and the number of overruns.
+    * @note stats is resized only if its size is not 4*(getNrOfStages()+1)+2 .
+    */
+    void getStatistics(yarp::sig::Vector &stats) const;
+
+    /**
+    * Get the statistics as a human readable string.
+    */
+    std::string getStatisticsString() const;
+};
+
+}
+
+}
+
+}
+
+#endif
@@ -163,31 +163,41 @@ const Vector & Filter::filt(const Vector &u)
 }
 
 
+/**********************************************************************/
+void iCub::ctrl::realTime::computeFirstOrderLowPassCoeffs(const double cutFrequency,
+                                                          const double sampleTime,
+                                                          Eigen::Vector2d &num,
+                                                          Eigen::Vector2d &den)
+{
+    double tau=1.0/(2.0*M_PI*cutFrequency);
+    num << sampleTime, sampleTime;
+    den << 2.0*tau+sampleTime, sampleTime-2.0*tau;
+}
+
+
 /**********************************************************************/
 FirstOrderLowPassFilter::FirstOrderLowPassFilter(const double cutFrequency,
                                                  const double sampleTime,
-                                                 const Vector &y0)
+                                                 const Vector &y0): filter(y0.size())
 {
     fc=cutFrequency;
     Ts=sampleTime;
     y=y0;
-    filter=NULL;
     computeCoeff();
+    filter.init(toEigen(y0));
 }
 
 
 /**********************************************************************/
 FirstOrderLowPassFilter::~FirstOrderLowPassFilter()
 {
-    delete filter;
 }
 
 
 /***************************************************************************/
 void FirstOrderLowPassFilter::init(const Vector &y0)
 {
-    if (filter!=NULL)
-        filter->init(y0);
+    filter.init(toEigen(y0));
 }
 
 
@@ -227,8 +237,8 @@ bool FirstOrderLowPassFilter::setSampleTime(const double sampleTime)
 /**********************************************************************/
 const Vector& FirstOrderLowPassFilter::filt(const Vector &u)
 {
-    if (filter!=NULL)
-        y=filter->filt(u);
+    // Write directly in the preallocated output buffer, without copying yarp vectors
+    toEigen(y)=filter.filt(toEigen(u));
 
     return y;
 }
@@ -237,13 +247,7 @@ const Vector& FirstOrderLowPassFilter::filt(const Vector &u)
 /**********************************************************************/
 void FirstOrderLowPassFilter::computeCoeff()
 {
-    double tau=1.0/(2.0*M_PI*fc);
-    Vector num=cat(Ts,Ts);
-    Vector den=cat(2.0*tau+Ts,Ts-2.0*tau);
-
-    if (filter!=NULL)
-        filter->adjustCoeffs(num,den);
-    else
-        filter=new Filter(num,den,y);
+    Eigen::Vector2d num, den;
+    computeFirstOrderLowPassCoeffs(fc,Ts,num,den);
+    filter.adjustCoeffs(num,den);
 }
-
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2016 Fondazione Istituto Italiano di Tecnologia
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+*/
+
+#include "ctrlLibRT/timing.h"
+
+#include <yarp/os/Time.h>
+
+#include <cmath>
+#include <sstream>
+
+using namespace yarp::sig;
+using namespace iCub::ctrl::realTime;
+
+/***************************************************************************/
+LatencyHistogram::LatencyHistogram(const double lowestTrackableValue,
+                                   const int nrOfOctaves,
+                                   const int subBucketsPerOctave):
+                                   buckets(nrOfOctaves*subBucketsPerOctave,0),
+                                   lowest(lowestTrackableValue),
+                                   octaves(nrOfOctaves),
+                                   subBuckets(subBucketsPerOctave)
+{
+    reset();
+}
+
+
+/***************************************************************************/
+void LatencyHistogram::reset()
+{
+    for (size_t i=0; i<buckets.size(); i++)
+        buckets[i]=0;
+
+    count=0;
+    sum=0.0;
+    max=0.0;
+}
+
+
+/***************************************************************************/
+void LatencyHistogram::record(const double value)
+{
+    size_t bucket=0;
+
+    if (value>=lowest)
+    {
+        // value/lowest = m*2^e with m in [0.5,1) and e >= 1
+        int e;
+        double m=frexp(value/lowest,&e);
+
+        int octave=e-1;
+        int subBucket=(int)((2.0*m-1.0)*subBuckets);
+
+        if (octave>=octaves)
+            bucket=buckets.size()-1;
+        else
+            bucket=(size_t)(octave*subBuckets+subBucket);
+    }
+
+    buckets[bucket]++;
+
+    count++;
+    sum+=value;
+    if (value>max)
+        max=value;
+}
+
+
+/***************************************************************************/
+double LatencyHistogram::getBucketUpperBound(const size_t bucket) const
+{
+    int octave=(int)(bucket/subBuckets);
+    int subBucket=(int)(bucket%subBuckets);
+
+    return ldexp(lowest*(1.0+(subBucket+1.0)/subBuckets),octave);
+}
+
+
+/***************************************************************************/
+double LatencyHistogram::getPercentile(const double percentile) const
+{
+    if (count==0)
+        return 0.0;
+
+    double target=ceil((percentile/100.0)*count);
+    if (target<1.0)
+        target=1.0;
+
+    unsigned long cumulative=0;
+    for (size_t i=0; i<buckets.size(); i++)
+    {
+        cumulative+=buckets[i];
+        if (cumulative>=target)
+        {
+            // The upper bound of the bucket can not be larger than the max
+            double upperBound=getBucketUpperBound(i);
+            return (upperBound<max)?upperBound:max;
+        }
+    }
+
+    return max;
+}
+
+
+/***************************************************************************/
+PipelineTimingRecorder::PipelineTimingRecorder(): period(0.0),
+                                                  nrOfOverruns(0),
+                                                  cycleStartTime(0.0),
+                                                  stageStartTime(0.0)
+{
+}
+
+
+/***************************************************************************/
+void PipelineTimingRecorder::init(const std::vector<std::string> &names,
+                                  const double periodInSeconds)
+{
+    stageNames=names;
+    stageHistograms.resize(names.size());
+    lastStageDurations.resize(names.size());
+    period=periodInSeconds;
+
+    reset();
+}
+
+
+/***************************************************************************/
+void PipelineTimingRecorder::reset()
+{
+    for (size_t i=0; i<stageHistograms.size(); i++)
+    {
+        stageHistograms[i].reset();
+        lastStageDurations[i]=0.0;
+    }
+
+    cycleHistogram.reset();
+    nrOfOverruns=0;
+}
+
+
+/***************************************************************************/
+void PipelineTimingRecorder::startCycle()
+{
+    cycleStartTime=yarp::os::Time::now();
+    stageStartTime=cycleStartTime;
+}
+
+
+/***************************************************************************/
+void PipelineTimingRecorder::endStage(const size_t stage)
+{
+    double now=yarp::os::Time::now();
+
+    lastStageDurations[stage]=now-stageStartTime;
+    stageHistograms[stage].record(lastStageDurations[stage]);
+
+    stageStartTime=now;
+}
+
+
+/***************************************************************************/
+void PipelineTimingRecorder::endCycle()
+{
+    double cycleDuration=yarp::os::Time::now()-cycleStartTime;
+
+    cycleHistogram.record(cycleDuration);
+
+    if (cycleDuration>period)
+        nrOfOverruns++;
+}
+
+
+/***************************************************************************/
+void PipelineTimingRecorder::getStatistics(Vector &stats) const
+{
+    size_t nrOfStages=stageNames.size();
+    size_t statsSize=4*(nrOfStages+1)+2;
+
+    if (stats.size()!=statsSize)
+        stats.resize(statsSize);
+
+    for (size_t i=0; i<nrOfStages; i++)
+    {
+        stats[4*i+0]=lastStageDurations[i];
+        stats[4*i+1]=stageHistograms[i].getPercentile(50.0);
+        stats[4*i+2]=stageHistograms[i].getPercentile(99.0);
+        stats[4*i+3]=stageHistograms[i].getMax();
+    }
+
+    double lastCycleDuration=0.0;
+    for (size_t i=0; i<nrOfStages; i++)
+        lastCycleDuration+=lastStageDurations[i];
+
+    stats[4*nrOfStages+0]=lastCycleDuration;
+    stats[4*nrOfStages+1]=cycleHistogram.getPercentile(50.0);
+    stats[4*nrOfStages+2]=cycleHistogram.getPercentile(99.0);
+    stats[4*nrOfStages+3]=cycleHistogram.getMax();
+
+    stats[4*nrOfStages+4]=(double)getNrOfCycles();
+    stats[4*nrOfStages+5]=(double)nrOfOverruns;
+}
+
+
+/***************************************************************************/
+std::string PipelineTimingRecorder::getStatisticsString() const
+{
+    std::stringstream ss;
+
+    ss << "Cycles: " << getNrOfCycles() << " Overruns of the " << 1e3*period << " ms period: " << nrOfOverruns << std::endl;
+    ss << "Stage : p50 p99 max (ms)" << std::endl;
+
+    for (size_t i=0; i<stageNames.size(); i++)
+    {
+        ss << stageNames[i] << " : "
+           << 1e3*stageHistograms[i].getPercentile(50.0) << " "
+           << 1e3*stageHistograms[i].getPercentile(99.0) << " "
+           << 1e3*stageHistograms[i].getMax() << std::endl;
+    }
+
+    ss << "cycle : "
+       << 1e3*cycleHistogram.getPercentile(50.0) << " "
+       << 1e3*cycleHistogram.getPercentile(99.0) << " "
+       << 1e3*cycleHistogram.getMax() << std::endl;
+
+    return ss.str();
+}
@@ -2,6 +2,29 @@
 #include <yarpWholeBodyInterface/yarpWholeBodyModel.h>
 #include <yarpWholeBodyInterface/yarpWholeBodyStates.h>
 #include "floatingBaseOdometry.h"
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+#include <vector>
+
+/**
+ * Buffers used by IKinematics. Passing the same workspace to consecutive calls
+ * (e.g. for all the samples of a trajectory, each one warm-started from the solution
+ * of the previous sample) avoids any memory allocation after the first call.
+ * A workspace must not be shared by calls running concurrently.
+ */
+struct IKWorkspace
+{
+    typedef Eigen::Matrix<double,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> MatrixXd_row;
+
+    MatrixXd_row J;                       // stacked 6*tasks x (6+dofs) jacobian, row major as expected by wbi
+    Eigen::VectorXd e;                    // stacked task errors
+    Eigen::MatrixXd JJt;                  // J*J^T plus the diagonal damping
+    Eigen::LLT<Eigen::MatrixXd> llt;
+    Eigen::VectorXd y;                    // (J*J^T + damping)^-1 * e
+    Eigen::VectorXd delta_theta;
+
+    void resize(int nrOfTasks, int dofs);
+};
 
 void getEulerAngles(Eigen::Matrix3d R, Eigen::Vector3d& angles, std::string order);
 Eigen::MatrixXd CalcOrientationEulerXYZ (const Eigen::VectorXd &input, std::string order);
@@ -19,4 +42,5 @@ bool IKinematics (yarpWbi::yarpWholeBodyModel* wbm,
                   bool switch_fixed = false,
                   double step_tol = 1e-8,
                   double lambda = 0.001,
-                  unsigned int max_iter = 100);
+                  unsigned int max_iter = 100,
+                  IKWorkspace* workspace = NULL);
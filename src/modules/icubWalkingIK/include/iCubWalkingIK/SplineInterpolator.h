@@ -2,6 +2,7 @@
 #ifndef SPLINEINTERPOLATOR_H
 #define SPLINEINTERPOLATOR_H
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <vector>
@@ -16,7 +17,9 @@
 template <typename VectorType>
 struct SplineInterpolator {
 	SplineInterpolator() :
-		initialized(false) {}
+		initialized(false),
+		dimension(0),
+		cursor(1) {}
     
     /** Time values found in the input file
      */
@@ -35,15 +38,19 @@ struct SplineInterpolator {
 	bool generateFromCSV (const char* filename);
 	void addPoints (double t, const VectorType &values);
     /** Computes derivatives of the input data storing 
-     *  them in m_values
+     *  them in m_values, and the polynomial coefficients of each segment
      */
 	void initialize ();
 
-    /** Calls initialize() and getInterpolants() 
+    /** Calls initialize() and evaluates the segment containing t
      */
 	VectorType getValues (double t);
 	VectorType getDerivatives (double t);
 	VectorType getSecondDerivatives (double t);
+    /** Evaluates values, first and second derivatives at t with a single segment lookup.
+     *  The outputs are resized only if their size is wrong.
+     */
+	void getValuesAndDerivatives (double t, VectorType &values, VectorType &derivatives, VectorType &second_derivatives);
 
 	double getStartTime();
 	double getEndTime();
@@ -51,24 +58,30 @@ struct SplineInterpolator {
 	bool initialized;
 
 	private:
-	double h00 (double t) { return 2. * t * t * t - 3. * t * t + 1.; };
-	double h10 (double t) { return t * t * t - 2. * t * t + t; };
-	double h01 (double t) { return - 2. * t * t * t + 3. * t * t; };
-	double h11 (double t) { return t * t * t - t * t; };
-
-	double h00_dot (double t) { return 6. * t * t - 6. * t; };
-	double h10_dot (double t) { return 3. * t * t - 4. * t + 1.; };
-	double h01_dot (double t) { return - 6. * t * t + 6. * t; };
-	double h11_dot (double t) { return 3. * t * t - 2. * t; };
-
-	double h00_ddot (double t) { return 12. * t - 6.; };
-	double h10_ddot (double t) { return 6. * t - 4.; };
-	double h01_ddot (double t) { return - 12. * t + 6.; };
-	double h11_ddot (double t) { return 6. * t - 2.; };
-    /** For a desired time t, it returns the two consecutive times and coordinates
-     *  as read from the input file that will contain it.
+	/** Size of the interpolated vectors
+	 */
+	int dimension;
+	/** Coefficients of the cubic polynomial of each segment, in the time elapsed from the beginning
+	 *  of the segment: p(s) = a + b*s + c*s^2 + d*s^3. The 4*dimension coefficients of segment i
+	 *  (between t_values[i] and t_values[i + 1]) are stored contiguously from 4*dimension*i as a, b, c, d.
+	 */
+	std::vector<double> coefficients;
+	/** Segment found by the last lookup, as index of its end time. Checked first, together with the
+	 *  following one, so that increasing times are found in constant time.
+	 */
+	size_t cursor;
+
+	/** True if t is not beyond the end time t1 of a segment
+	 */
+	struct EndsAfter {
+		bool operator() (double t, double t1) const { return t - t1 < std::numeric_limits<double>::epsilon(); }
+	};
+	bool isSegmentOf (double t, size_t i);
+    /** For a desired time t, it returns the index i such that t_values[i - 1] and t_values[i] are the
+     *  two consecutive times read from the input file that contain it.
      */
-	void getInterpolants (double t, double &t0, double &t1, VectorType &p0, VectorType &m0, VectorType &p1, VectorType &m1);
+	size_t findSegment (double t);
+	const double * segmentCoefficients (double t, double &s);
 };
 
 template <typename VectorType>
@@ -172,101 +185,130 @@ inline void SplineInterpolator<VectorType>::initialize() {
 //		std::cerr << "Added derivatives: " << m_value.transpose() << std::endl;
 	}
 
+	// Hermite basis of each segment expanded in powers of the time elapsed from its beginning
+	dimension = p_values[0].size();
+	coefficients.resize(4 * dimension * (t_values.size() - 1));
+	for (size_t i = 0; i + 1 < t_values.size(); i++) {
+		double h = t_values[i + 1] - t_values[i];
+		double * a = &coefficients[4 * dimension * i];
+		double * b = a + dimension;
+		double * c = b + dimension;
+		double * d = c + dimension;
+		for (int k = 0; k < dimension; k++) {
+			double dp = p_values[i + 1][k] - p_values[i][k];
+			a[k] = p_values[i][k];
+			b[k] = m_values[i][k];
+			c[k] = (3. * dp / h - 2. * m_values[i][k] - m_values[i + 1][k]) / h;
+			d[k] = (- 2. * dp / h + m_values[i][k] + m_values[i + 1][k]) / (h * h);
+		}
+	}
+	cursor = 1;
+
 	initialized = true;
 }
 
 template <typename VectorType>
-inline void SplineInterpolator<VectorType>::getInterpolants (double t, double &t0, double &t1, VectorType &p0, VectorType &m0, VectorType &p1, VectorType &m1) {
-	for (size_t i = 1; i < t_values.size(); i ++) {
-		if (t >= t_values[i - 1] && (t <= t_values[i] || t - t_values[i] < std::numeric_limits<double>::epsilon())) {
-			t0 = t_values[i - 1];
-			t1 = t_values[i];
-			p0 = p_values[i - 1];
-			m0 = m_values[i - 1];
-			p1 = p_values[i];
-			m1 = m_values[i];
-			
-			return;
-		}
+inline bool SplineInterpolator<VectorType>::isSegmentOf (double t, size_t i) {
+	// Same as the first segment found scanning them in order
+	return i >= 1 && i < t_values.size()
+		&& t >= t_values[i - 1] && EndsAfter()(t, t_values[i])
+		&& (i == 1 || !EndsAfter()(t, t_values[i - 1]));
+}
+
+template <typename VectorType>
+inline size_t SplineInterpolator<VectorType>::findSegment (double t) {
+	if (isSegmentOf(t, cursor)) {
+		return cursor;
+	}
+	if (isSegmentOf(t, cursor + 1)) {
+		return ++cursor;
+	}
+
+	size_t i = std::upper_bound(t_values.begin() + 1, t_values.end(), t, EndsAfter()) - t_values.begin();
+	if (i < t_values.size() && t >= t_values[i - 1]) {
+		cursor = i;
+		return i;
 	}
 
 	std::cerr.precision(16);
 	std::cerr << "Could not find interpolants at time " << std::scientific << t << ". Range is [" << getStartTime() << ", " << getEndTime() << "]!" << std::endl;
 	abort();
+	return 0;
 }
 
 template <typename VectorType>
-inline VectorType SplineInterpolator<VectorType>::getValues(double t) {
+inline const double * SplineInterpolator<VectorType>::segmentCoefficients (double t, double &s) {
 	initialize();
 
-	double t0;
-	double t1;
-	VectorType p0 (VectorType::Zero(p_values[0].size()));
-	VectorType m0 (VectorType::Zero(p_values[0].size()));
-	VectorType p1 (VectorType::Zero(p_values[0].size()));
-	VectorType m1 (VectorType::Zero(p_values[0].size()));
-
-	getInterpolants (t, t0, t1, p0, m0, p1, m1);	
-
-//	std::cout << "Using interpolants: t0 = " << t0 << " t1 = " << t1 << std::endl 
-//		<< " p0 = " << p0.transpose() << std::endl
-//		<< " m0 = " << m0.transpose() << std::endl
-//		<< " p1 = " << p1.transpose() << std::endl
-//		<< " m1 = " << m1.transpose() << std::endl;
-
-	double tau = (t - t0) / (t1 - t0);
+	size_t i = findSegment(t);
+	s = t - t_values[i - 1];
+	return &coefficients[4 * dimension * (i - 1)];
+}
 
-	return h00(tau) * p0 + h10(tau) * (t1 - t0) * m0 + h01(tau) * p1 + h11(tau) * (t1 - t0) * m1;
+template <typename VectorType>
+inline VectorType SplineInterpolator<VectorType>::getValues(double t) {
+	double s;
+	const double * a = segmentCoefficients(t, s);
+	const double * b = a + dimension;
+	const double * c = b + dimension;
+	const double * d = c + dimension;
+
+	VectorType values (dimension);
+	for (int k = 0; k < dimension; k++) {
+		values[k] = a[k] + s * (b[k] + s * (c[k] + s * d[k]));
+	}
+	return values;
 }
 
 template <typename VectorType>
 inline VectorType SplineInterpolator<VectorType>::getDerivatives(double t) {
-	initialize();
-
-	double t0;
-	double t1;
-	VectorType p0 (VectorType::Zero(p_values[0].size()));
-	VectorType m0 (VectorType::Zero(p_values[0].size()));
-	VectorType p1 (VectorType::Zero(p_values[0].size()));
-	VectorType m1 (VectorType::Zero(p_values[0].size()));
-
-	getInterpolants (t, t0, t1, p0, m0, p1, m1);	
-
-//	std::cout << "Using interpolants: t0 = " << t0 << " t1 = " << t1 << std::endl 
-//		<< " p0 = " << p0.transpose() << std::endl
-//		<< " m0 = " << m0.transpose() << std::endl
-//		<< " p1 = " << p1.transpose() << std::endl
-//		<< " m1 = " << m1.transpose() << std::endl;
-
-	double tau = (t - t0) / (t1 - t0);
-	double taudot = (1.) / ((t1 - t0));
-
-	return h00_dot(tau) * taudot * p0 + h10_dot(tau) * taudot * (t1 - t0) * m0 + h01_dot(tau) * taudot * p1 + h11_dot(tau) * taudot * (t1 - t0) * m1;
+	double s;
+	const double * b = segmentCoefficients(t, s) + dimension;
+	const double * c = b + dimension;
+	const double * d = c + dimension;
+
+	VectorType derivatives (dimension);
+	for (int k = 0; k < dimension; k++) {
+		derivatives[k] = b[k] + s * (2. * c[k] + s * 3. * d[k]);
+	}
+	return derivatives;
 }
 
 template <typename VectorType>
 inline VectorType SplineInterpolator<VectorType>::getSecondDerivatives(double t) {
-	initialize();
-
-	double t0;
-	double t1;
-	VectorType p0 (VectorType::Zero(p_values[0].size()));
-	VectorType m0 (VectorType::Zero(p_values[0].size()));
-	VectorType p1 (VectorType::Zero(p_values[0].size()));
-	VectorType m1 (VectorType::Zero(p_values[0].size()));
+	double s;
+	const double * c = segmentCoefficients(t, s) + 2 * dimension;
+	const double * d = c + dimension;
 
-	getInterpolants (t, t0, t1, p0, m0, p1, m1);	
-
-//	std::cout << "Using interpolants: t0 = " << t0 << " t1 = " << t1 << std::endl 
-//		<< " p0 = " << p0.transpose() << std::endl
-//		<< " m0 = " << m0.transpose() << std::endl
-//		<< " p1 = " << p1.transpose() << std::endl
-//		<< " m1 = " << m1.transpose() << std::endl;
-
-	double tau = (t - t0) / (t1 - t0);
-	double taudot_2 = (1.) / ((t1 - t0) * (t1 - t0));
+	VectorType second_derivatives (dimension);
+	for (int k = 0; k < dimension; k++) {
+		second_derivatives[k] = 2. * c[k] + 6. * d[k] * s;
+	}
+	return second_derivatives;
+}
 
-	return h00_ddot(tau) * taudot_2 * p0 + h10_ddot(tau) * taudot_2 * (t1 - t0) * m0 + h01_ddot(tau) * taudot_2 * p1 + h11_ddot(tau) * taudot_2 * (t1 - t0) * m1;
+template <typename VectorType>
+inline void SplineInterpolator<VectorType>::getValuesAndDerivatives(double t, VectorType &values, VectorType &derivatives, VectorType &second_derivatives) {
+	double s;
+	const double * a = segmentCoefficients(t, s);
+	const double * b = a + dimension;
+	const double * c = b + dimension;
+	const double * d = c + dimension;
+
+	if (values.size() != dimension) {
+		values.resize(dimension);
+	}
+	if (derivatives.size() != dimension) {
+		derivatives.resize(dimension);
+	}
+	if (second_derivatives.size() != dimension) {
+		second_derivatives.resize(dimension);
+	}
+	for (int k = 0; k < dimension; k++) {
+		values[k] = a[k] + s * (b[k] + s * (c[k] + s * d[k]));
+		derivatives[k] = b[k] + s * (2. * c[k] + s * 3. * d[k]);
+		second_derivatives[k] = 2. * c[k] + 6. * d[k] * s;
+	}
 }
 
 template <typename VectorType>
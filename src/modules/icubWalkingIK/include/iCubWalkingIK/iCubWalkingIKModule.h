@@ -13,6 +13,7 @@ private:
     iCubWalkingIKThread*            thread;
     yarpWbi::yarpWholeBodyModel*           m_robotModel;
     yarpWbi::yarpWholeBodyStates*          m_robotStates;
+    std::vector<yarpWbi::yarpWholeBodyModel*> m_batchRobotModels;
     std::string                     m_moduleName;
     std::string                     m_robotName;
     walkingParams                   m_params;
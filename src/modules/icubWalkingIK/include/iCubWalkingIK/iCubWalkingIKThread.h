@@ -26,6 +26,9 @@
 #include <yarp/os/Time.h>
 #include <yarp/os/Port.h>
 #include <yarp/os/Semaphore.h>
+#include <yarp/os/Thread.h>
+
+#include <vector>
 
 #include <yarpWholeBodyInterface/yarpWholeBodyModel.h>
 #include <yarpWholeBodyInterface/yarpWholeBodyStates.h>
@@ -36,8 +39,58 @@
 #include "floatingBaseOdometry.h"
 #include "paramsStructures.h"
 
+/**
+ *  Planned feet and COM trajectories used as targets by the inverse kinematics, together with its results.
+ */
+struct IKTrajectory {
+    std::vector<Eigen::VectorXd> l_foot;
+    std::vector<Eigen::VectorXd> r_foot;
+    std::vector<Eigen::VectorXd> com;
+    std::vector<unsigned int> body_ids;
+    std::vector<Eigen::Vector3d> body_points;
+    std::vector<Eigen::Matrix3d> target_orientation;
+    // Results
+    std::vector<Eigen::VectorXd> res;
+    std::vector<Eigen::VectorXd> com_real;
+    std::vector<Eigen::VectorXd> l_foot_real;
+    std::vector<Eigen::VectorXd> r_foot_real;
+};
+
+/**
+ *  Samples [begin, end) of the trajectory, solved with their own model and odometry. The samples
+ *  [warmupBegin, begin) are solved first to warm-start the solution of the chunk, and their results are
+ *  kept apart to be blended with the ones of the previous chunk.
+ */
+struct IKTrajectoryChunk {
+    yarpWbi::yarpWholeBodyModel* wbm;
+    floatingBaseOdometry* odometry;
+    int warmupBegin;
+    int begin;
+    int end;
+    Eigen::VectorXd qinit;
+    // Foot fixed at warmupBegin and world offset the odometry has been initialized with
+    std::string fixed_foot;
+    KDL::Vector world_offset;
+    // Joint configurations of the warm-up samples, indexed from warmupBegin
+    std::vector<Eigen::VectorXd> warmup_res;
+    bool print_progress;
+};
+
 class iCubWalkingIKThread: public yarp::os::RateThread {
 private:
+    /**
+     *  Solves a chunk of the trajectory in its own thread.
+     */
+    class IKChunkSolver: public yarp::os::Thread {
+    private:
+        iCubWalkingIKThread& m_owner;
+        IKTrajectory& m_trajectory;
+        IKTrajectoryChunk& m_chunk;
+    public:
+        IKChunkSolver(iCubWalkingIKThread& owner, IKTrajectory& trajectory, IKTrajectoryChunk& chunk);
+        void run();
+    };
+
     int m_period;
     std::string m_walkingPatternFile;
     walkingParams m_walkingParams;
@@ -46,8 +99,11 @@ private:
     yarp::os::ResourceFinder m_rf;
     yarpWbi::yarpWholeBodyModel* m_wbm;
     yarpWbi::yarpWholeBodyStates* m_wbs;
+    std::vector<yarpWbi::yarpWholeBodyModel*> m_batchModels;
     std::string m_outputDir;
     floatingBaseOdometry* m_odometry;
+    // Position of the world origin in the initial world reference frame, as passed to m_odometry
+    KDL::Vector m_initial_world_offset;
     floatingBaseOdometry* m_walkingOdometry;
     yarp::os::Port m_rpc_port;
     
@@ -61,6 +117,20 @@ private:
     bool m_switch_foot;
     bool m_stream_floating_base_flag;
     
+    /**
+     *  True if the fixed foot of the odometry is switched at sample i, i.e. when one of the feet starts lifting from the ground.
+     */
+    bool isSwitchingFixedFoot(const IKTrajectory &trajectory, int i);
+    
+    /**
+     *  Splits the trajectory in one chunk for each model in m_batchModels plus one solved with m_wbm and m_odometry,
+     *  and solves them concurrently. Across the warm-up samples of each chunk its solution is linearly blended
+     *  with the one of the previous chunk, so that the trajectory is continuous at the seams.
+     *
+     *  @return false if the trajectory could not be split and must be solved serially
+     */
+    bool solveTrajectoryBatch(IKTrajectory &trajectory, const Eigen::VectorXd &qinit);
+    
 public:
     yarp::os::Semaphore  thread_mutex;
     bool planner_flag;
@@ -68,6 +138,7 @@ public:
     iCubWalkingIKThread (int period,
                          yarpWbi::yarpWholeBodyModel* wbm,
                          yarpWbi::yarpWholeBodyStates* wbs,
+                         const std::vector<yarpWbi::yarpWholeBodyModel*> &batchModels,
                          walkingParams params,
                          odometryParams &odometry_params,
                          inverseKinematicsParams &inverseKin_params,
@@ -82,6 +153,15 @@ public:
                                   walkingParams params);
     void inverseKinematics(walkingParams params);
     
+    /**
+     *  Solves the inverse kinematics for the samples of a chunk, each one warm-started from the solution of the previous one.
+     *  Chunks with different models and odometries can be solved concurrently.
+     *
+     *  @param trajectory Targets, and results of the samples [chunk.begin, chunk.end)
+     *  @param chunk      Samples to solve and objects used to solve them
+     */
+    void solveTrajectoryChunk(IKTrajectory &trajectory, IKTrajectoryChunk &chunk);
+    
     /**
      *  Computes a distance vector that goes from ref_frame to the center of both feet at the current configuration
      *
@@ -94,7 +174,7 @@ public:
     
     bool updateCOMreal(floatingBaseOdometry * odometry, Eigen::VectorXd &com_real, Eigen::VectorXd offset);
     
-    bool updateFootTrajReal(floatingBaseOdometry * odometry, double * q, Eigen::VectorXd &foot_real, std::string which_foot);
+    bool updateFootTrajReal(yarpWbi::yarpWholeBodyModel * wbm, floatingBaseOdometry * odometry, double * q, Eigen::VectorXd &foot_real, std::string which_foot);
 };
 
 #endif
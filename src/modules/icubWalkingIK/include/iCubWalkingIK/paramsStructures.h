@@ -26,6 +26,8 @@ struct inverseKinematicsParams{
     double lambda;
     int    max_iter;
     int    trials_initial_IK;
+    int    batch_workers;
+    int    batch_overlap;
 };
 
 #endif
\ No newline at end of file
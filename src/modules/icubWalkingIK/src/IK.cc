@@ -4,8 +4,7 @@
 #include <yarpWholeBodyInterface/yarpWholeBodyStates.h>
 #include <Eigen/Dense>
 #include <Eigen/Core>
-#include <Eigen/LU>
-#include <Eigen/SVD>
+#include <Eigen/Cholesky>
 #include <Eigen/Geometry>
 #include <iCub/iDynTree/DynTree.h>
 #include <iDynTree/Estimation/simpleLeggedOdometryKDL.h>
@@ -14,7 +13,18 @@
 //using namespace qpOASES;
 //using namespace RigidBodyDynamics;
 using namespace Eigen;
-typedef Eigen::Matrix<double,-1,-1,Eigen::RowMajor> MatrixXd_row;
+
+void IKWorkspace::resize(int nrOfTasks, int dofs)
+{
+    if (J.rows() != 6*nrOfTasks || J.cols() != dofs+6)
+    {
+        J.setZero(6*nrOfTasks, dofs+6);
+        e.setZero(6*nrOfTasks);
+        JJt.setZero(6*nrOfTasks, 6*nrOfTasks);
+        y.setZero(6*nrOfTasks);
+        delta_theta.setZero(dofs+6);
+    }
+}
 
 void getEulerAngles(Eigen::Matrix3d R, Eigen::Vector3d& angles, std::string order)
 {
@@ -98,16 +108,24 @@ bool IKinematics (yarpWbi::yarpWholeBodyModel* wbm,
                   bool switch_fixed,
                   double step_tol,
                   double lambda,
-                  unsigned int max_iter)
+                  unsigned int max_iter,
+                  IKWorkspace* workspace)
 {
     assert (Qinit.size() == wbm->getDoFs());
     assert (body_id.size() == target_pos.size());
     assert (body_id.size() == body_point.size());
     assert (body_id.size() == target_orientation.size());
 
-    Eigen::MatrixXd J = Eigen::MatrixXd::Zero(6 * body_id.size(), wbm->getDoFs()+6);
-    Eigen::VectorXd e = Eigen::VectorXd::Zero(6 * body_id.size());
+    const int dofs = wbm->getDoFs();
+    const int nrOfTasks = body_id.size();
+
+    IKWorkspace localWorkspace;
+    IKWorkspace & ws = workspace ? *workspace : localWorkspace;
+    ws.resize(nrOfTasks, dofs);
+    IKWorkspace::MatrixXd_row & J = ws.J;
+    Eigen::VectorXd & e = ws.e;
 
+    // Warm start from the initial guess (e.g. the solution of the previous trajectory sample)
     Qres = Qinit;
 
 //FIXME: parameter for switching fixed foot switch_fixed, the fixed link update should happen only once at the beginning
@@ -116,30 +134,28 @@ bool IKinematics (yarpWbi::yarpWholeBodyModel* wbm,
     for (unsigned int ik_iter = 0; ik_iter < max_iter; ik_iter++) {
 //        UpdateKinematicsCustom (model, &Qres, NULL, NULL);
 
-        for (unsigned int k = 0; k < body_id.size(); k++) {
-            // Initializing Jacobian matrix to 6 x DOFS
-            MatrixXd_row G (Eigen::MatrixXd::Zero(6, wbm->getDoFs() + 6));
-            wbi::Frame base_H_world;
-            // Update odometry and compute world_H_floatingbase
-            //!!!!: parameter for switching fixed foot switch_fixed, the fixed link update should NOT happen inside the IK iterations
+        // Update odometry and compute world_H_floatingbase, once for all the tasks
+        //!!!!: parameter for switching fixed foot switch_fixed, the fixed link update should NOT happen inside the IK iterations
+        if (ik_iter > 0) {
             odometry->update(Qres.data(), false);
-            wbi::Frame world_H_floatingbase;
-            odometry->get_world_H_floatingbase(world_H_floatingbase);
-            wbm->computeJacobian(Qres.data(), world_H_floatingbase, body_id[k], G.data(), body_point[k].data());
+        }
+        wbi::Frame world_H_floatingbase;
+        odometry->get_world_H_floatingbase(world_H_floatingbase);
+
+        for (int k = 0; k < nrOfTasks; k++) {
+            // The 6 x (6+DOFS) jacobian of the task is written directly in its rows of the (row major) stacked jacobian
+            wbm->computeJacobian(Qres.data(), world_H_floatingbase, body_id[k], J.data() + 6*k*J.cols(), body_point[k].data());
 //            CalcPointJacobian6D (model, Qres, body_id[k], body_point[k], G, false);
 
             // Calculate coordinates of a point in the root reference frame
-            Eigen::VectorXd point_pose(7);
+            Eigen::Matrix<double,7,1> point_pose;
             wbm->forwardKinematics(Qres.data(), world_H_floatingbase, body_id[k], point_pose.data(), body_point[k].data());
-            Eigen::Vector3d point_base = point_pose.head(3);
 //            Eigen::Vector3d point_base = CalcBodyToBaseCoordinates (model, Qres, body_id[k], body_point[k], false);
 
             // Calculate orientation of a given body as 3x3 matrix
-            Eigen::VectorXd orientationAxisAngle(4);
-            orientationAxisAngle = point_pose.tail(4);
-            Eigen::AngleAxis<double> aa(orientationAxisAngle(3), Eigen::Vector3d(orientationAxisAngle(0),
-                                                                                 orientationAxisAngle(1),
-                                                                                 orientationAxisAngle(2)));
+            Eigen::AngleAxis<double> aa(point_pose(6), Eigen::Vector3d(point_pose(3),
+                                                                       point_pose(4),
+                                                                       point_pose(5)));
             Eigen::Matrix3d R = aa.toRotationMatrix();
 //            Eigen::Matrix3d R = CalcBodyWorldOrientation(model, Qres, body_id[k], false);
 
@@ -153,17 +169,9 @@ bool IKinematics (yarpWbi::yarpWholeBodyModel* wbm,
             if(!target_orientation[k].isZero(0))
                 ort_rates = R*CalcAngularVelocityfromMatrix(target_orientation[k]*R.transpose());
 
-            for (unsigned int i = 0; i < 6; i++) {
-                for (unsigned int j = 0; j < wbm->getDoFs()+6; j++) {
-                    unsigned int row = k * 6 + i;
-                    J(row, j) = G (i,j);
-                }
-            }
             //NOTE: With RBDL first, we would have ort_rates and then (target_pos - point_base)
-            for (unsigned int i = 0; i < 3; i++) {
-                e[k * 6 + i] = target_pos[k][i] - point_base[i];
-                e[k * 6 + i + 3] = ort_rates[i];
-            }
+            e.segment<3>(k*6) = target_pos[k] - point_pose.head<3>();
+            e.segment<3>(k*6 + 3) = ort_rates;
         }
 
         // abort if we are getting "close"
@@ -174,20 +182,17 @@ bool IKinematics (yarpWbi::yarpWholeBodyModel* wbm,
 
         double wn = lambda;
 
-        // "task space" from puppeteer
-        Eigen::MatrixXd Ek = Eigen::MatrixXd::Zero (e.size(), e.size());
-
-        for (size_t ei = 0; ei < e.size(); ei ++) {
-            Ek(ei,ei) = e[ei] * e[ei] * 0.5 + wn;
-        }
-
-        Eigen::MatrixXd JJT_Ek_wnI = J * J.transpose() + Ek;
-
-        Eigen::VectorXd delta_theta = J.transpose() * JJT_Ek_wnI.colPivHouseholderQr().solve (e);
-//        std::cerr << "Size of Qres: " << Qres.size() << " while size of delta_theta " << delta_theta.size() << std::endl;
-        //TODO: Here, size of Qres is 15 while size delta is 21
-        Qres = Qres + delta_theta.tail(15);
-        if (delta_theta.norm() < step_tol) {
+        // "task space" from puppeteer: J*J^T plus the diagonal damping Ek(i,i) = 0.5*e(i)^2 + wn,
+        // which is symmetric positive definite and can be solved with a Cholesky decomposition
+        ws.JJt.noalias() = J * J.transpose();
+        ws.JJt.diagonal().array() += 0.5 * e.array().square() + wn;
+
+        ws.llt.compute(ws.JJt);
+        ws.y = ws.llt.solve(e);
+        ws.delta_theta.noalias() = J.transpose() * ws.y;
+        // The first 6 elements are the floating base, that is computed by the odometry
+        Qres += ws.delta_theta.tail(dofs);
+        if (ws.delta_theta.norm() < step_tol) {
 //            std::cerr << "Reached target close enough with small delta_theta after " << ik_iter << " steps" << std::endl;
             return true;
         }
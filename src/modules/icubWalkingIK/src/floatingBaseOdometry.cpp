@@ -3,7 +3,8 @@
 using namespace yarpWbi;
 
 floatingBaseOdometry::floatingBaseOdometry(yarpWholeBodyModel * wbm) :
-m_wbm(wbm)
+m_wbm(wbm),
+m_joint_status(0)
 {
     // Here we assume that wbm has been correctly initialized.
     m_robot_model = m_wbm->getRobotModel();
@@ -3,6 +3,8 @@
 #include <yarp/os/Time.h>
 #include "iCubWalkingIKModule.h"
 
+#include <sstream>
+
 
 using namespace yarp::os;
 using namespace yarpWbi;
@@ -114,6 +116,30 @@ bool iCubWalkingIKModule::configure(ResourceFinder &rf) {
     m_inverseKinematicsParams.step_tolerance = inverseKinematicsBottle.find("step_tolerance").asDouble();
     m_inverseKinematicsParams.max_iter = inverseKinematicsBottle.find("max_iter").asInt();
     m_inverseKinematicsParams.trials_initial_IK = inverseKinematicsBottle.find("trials_initial_IK").asInt();
+    m_inverseKinematicsParams.batch_workers = inverseKinematicsBottle.check("batch_workers", yarp::os::Value(1)).asInt();
+    m_inverseKinematicsParams.batch_overlap = inverseKinematicsBottle.check("batch_overlap", yarp::os::Value(50)).asInt();
+    if ( m_inverseKinematicsParams.batch_workers <= 0 ) {
+        yError("batch_workers must be positive");
+        return false;
+    }
+    if ( m_inverseKinematicsParams.batch_overlap < 0 ) {
+        yError("batch_overlap cannot be negative");
+        return false;
+    }
+    
+    // Each additional worker of the batch inverse kinematics needs its own model of the robot
+    for (int k = 1; k < m_inverseKinematicsParams.batch_workers; k++) {
+        std::stringstream batchModelName;
+        batchModelName << m_moduleName << "_batch" << k;
+        yarpWbi::yarpWholeBodyModel* batchModel = new yarpWbi::yarpWholeBodyModel(batchModelName.str().c_str(), wbiProperties);
+        batchModel->addJoints(iCubMainJoints);
+        if (!batchModel->init()) {
+            yError("Could not initialize the WBM of batch inverse kinematics worker %d.", k);
+            delete batchModel;
+            return false;
+        }
+        m_batchRobotModels.push_back(batchModel);
+    }
     
     // Load walking pattern file
     std::string patternFile = rf.find("patternFile").asString();
@@ -123,6 +149,7 @@ bool iCubWalkingIKModule::configure(ResourceFinder &rf) {
     thread = new iCubWalkingIKThread(m_period,
                                      m_robotModel,
                                      m_robotStates,
+                                     m_batchRobotModels,
                                      m_params,
                                      m_odometryParams,
                                      m_inverseKinematicsParams,
@@ -203,6 +230,10 @@ void iCubWalkingIKModule::closure() {
         delete m_robotStates;
         m_robotStates = 0;
     }
+    for (size_t k = 0; k < m_batchRobotModels.size(); k++) {
+        delete m_batchRobotModels[k];
+    }
+    m_batchRobotModels.clear();
     m_rpc_port.interrupt();
     m_rpc_port.close();
 
@@ -1,8 +1,11 @@
 #include "iCubWalkingIKThread.h"
 
+#include <algorithm>
+
 iCubWalkingIKThread::iCubWalkingIKThread ( int period,
                                            yarpWbi::yarpWholeBodyModel* wbm,
                                            yarpWbi::yarpWholeBodyStates* wbs,
+                                           const std::vector<yarpWbi::yarpWholeBodyModel*> &batchModels,
                                            walkingParams params,
                                            odometryParams &odometry_params,
                                            inverseKinematicsParams &inverseKin_params,
@@ -18,6 +21,7 @@ m_inverseKinematicsParams(inverseKin_params),
 m_rf(rf),
 m_wbm(wbm),
 m_wbs(wbs),
+m_batchModels(batchModels),
 m_outputDir(outputDir)
 { }
 #pragma mark -
@@ -50,6 +54,7 @@ bool iCubWalkingIKThread::threadInit() {
         // Use the offset defined in the configuration file
         initial_world_offset = m_odometryParams.offset_from_world_reference_frame;
     }
+    m_initial_world_offset = initial_world_offset;
     std::string initial_world_frame_position = m_odometryParams.initial_world_reference_frame;
     std::string initial_fixed_link = m_odometryParams.initial_fixed_frame;
     std::string floating_base_frame_index = m_odometryParams.floating_base;
@@ -284,10 +289,13 @@ void iCubWalkingIKThread::inverseKinematics(walkingParams params) {
     
     // quantities to store trajectories read from file
     Eigen::VectorXd temp = Eigen::VectorXd::Zero(3);
-    std::vector<Eigen::VectorXd> l_foot(N,temp);
-    std::vector<Eigen::VectorXd> r_foot(N,temp);
-    std::vector<Eigen::VectorXd> com(N,temp);
-    Eigen::VectorXd time_vec(N);
+    IKTrajectory trajectory;
+    std::vector<Eigen::VectorXd> &l_foot = trajectory.l_foot;
+    std::vector<Eigen::VectorXd> &r_foot = trajectory.r_foot;
+    std::vector<Eigen::VectorXd> &com = trajectory.com;
+    l_foot.assign(N,temp);
+    r_foot.assign(N,temp);
+    com.assign(N,temp);
     
     //FIXME: This should be passed to the init method of this thread.
     // read the feet and com trajectories
@@ -301,17 +309,18 @@ void iCubWalkingIKThread::inverseKinematics(walkingParams params) {
     Eigen::VectorXd qinit = Eigen::VectorXd::Zero(m_wbm->getDoFs());
     // result of the inverse kinematics
     Eigen::VectorXd qres = Eigen::VectorXd::Zero(m_wbm->getDoFs());
-    // store all the resulting configurations
-    std::vector<Eigen::VectorXd> res(N,qres);
     
     // body ids of the bodies we want to use with IK
-    std::vector<unsigned int> body_ids(3);
+    std::vector<unsigned int> &body_ids = trajectory.body_ids;
+    body_ids.resize(3);
     // the points attached to the respective bodies
-    std::vector<Eigen::Vector3d> body_points(3);
+    std::vector<Eigen::Vector3d> &body_points = trajectory.body_points;
+    body_points.resize(3);
     // taget positions in world ref frame of the specified points
     std::vector<Eigen::Vector3d> target_pos(3);
     // target orientation
-    std::vector<Eigen::Matrix3d> target_orientation(3);
+    std::vector<Eigen::Matrix3d> &target_orientation = trajectory.target_orientation;
+    target_orientation.resize(3);
 
     // we want to match left and right feet and a point attached to the root as "CoM"
     // since IK of RBDL does not have the concept of orientation because it uses points, we need at least 3 points on each foot to ensure the foot comes flat on the ground
@@ -358,11 +367,17 @@ void iCubWalkingIKThread::inverseKinematics(walkingParams params) {
 //    qinit[15] = -0.57;
 //    qinit[16] = -0.23;
     
+    // store all the resulting configurations
+    std::vector<Eigen::VectorXd> &res = trajectory.res;
+    res.assign(N,qres);
     // Initializing variable to store actual com trajectory after solving inverse kinematics.
-    std::vector<Eigen::VectorXd> com_real(N,Eigen::Vector3d::Zero());
+    std::vector<Eigen::VectorXd> &com_real = trajectory.com_real;
+    com_real.assign(N,Eigen::Vector3d::Zero());
     // Initializing variable to store actual feet trajectory after solving inverse kinematics.
-    std::vector<Eigen::VectorXd> l_foot_real(N,Eigen::Vector3d::Zero());
-    std::vector<Eigen::VectorXd> r_foot_real(N,Eigen::Vector3d::Zero());
+    std::vector<Eigen::VectorXd> &l_foot_real = trajectory.l_foot_real;
+    std::vector<Eigen::VectorXd> &r_foot_real = trajectory.r_foot_real;
+    l_foot_real.assign(N,Eigen::Vector3d::Zero());
+    r_foot_real.assign(N,Eigen::Vector3d::Zero());
 
     // IK parameters
 #pragma mark NOTE: step_tol is now 1e-04, it does not converge for lower tollerances, you should not change lambda
@@ -381,13 +396,16 @@ void iCubWalkingIKThread::inverseKinematics(walkingParams params) {
 //    qinit << 0.370514, -0.00103353, -0.0194207, -0.695718, -0.321399, -0.00163334, 0.366373, -0.00112561, 0.0195639, -0.699534, -0.32928, -0.00163269, 0.0760014, -0.0174981, -1.44023e-06;
     std::cerr << qinit << std::endl;
 
+    // Buffers of the IK solver, reused by all the trials
+    IKWorkspace ik_workspace;
+
     //FIXME: parameter for switching fixed foot
     bool switch_fixed = false;
     for(int k = 0; k < trials; k++)
     {
     //FIXME: introduced parameter for switching fixed foot
         //NOTE: It would be nice if body_ids, target_pos, target_orientation, body_points, lambda and max_iter were put in some structure for inverse kinematics (like ik_params).
-        if (!IKinematics(m_wbm, m_wbs, m_odometry, qinit, body_ids, target_pos, target_orientation, body_points, qres, switch_fixed, step_tol, lambda, max_iter))
+        if (!IKinematics(m_wbm, m_wbs, m_odometry, qinit, body_ids, target_pos, target_orientation, body_points, qres, switch_fixed, step_tol, lambda, max_iter, &ik_workspace))
         {
             yWarning("iCubWalkingIKThread::inverseKinematics \n COM Inv. Kinematics \n - Could not converge to a solution with the desired tolerance of %lf", step_tol);
         } /*else {
@@ -413,76 +431,19 @@ void iCubWalkingIKThread::inverseKinematics(walkingParams params) {
     m_wbs->getEstimates(wbi::ESTIMATE_JOINT_POS, qinit.data());
     
     // perform inverse kinematics using all the defined points and the target positions as from the planned feet and com trajectories
-    double t = 0;
-    for(int i = 0; i < N; i++)
-    {
-        // Retrieve real COM in chest coordinates
-        int chestId;
-        m_wbm->getFrameList().idToIndex("chest", chestId);
-        wbi::Frame H_from_chest_to_root;
-        m_wbm->computeH(qinit.data(), wbi::Frame(), chestId, H_from_chest_to_root);
-        Eigen::VectorXd com_from_chest(7);
-        Eigen::VectorXd com_from_root(7);
-        //!!!!: Maybe in the following line instead of qres I should have qinit!!!
-        m_wbm->forwardKinematics(qinit.data(), H_from_chest_to_root, wbi::iWholeBodyModel::COM_LINK_ID, com_from_chest.data());
-        m_wbm->forwardKinematics(qinit.data(), wbi::Frame(), wbi::iWholeBodyModel::COM_LINK_ID, com_from_root.data());
-        body_points[2] = com_from_chest.head(3);
-//        std::cout << "com_from_chest: " << com_from_chest.head(3) << std::endl;
-//        std::cout << "com_from_root: " << com_from_root.head(3) << std::endl;
-        //!!!!: The following line is very specific to iCub and has been figured out comparing the height of the resulting COM with the resulting joint angles from inverse kinematics against the planned COM trajectory. The exact difference has been then used to find this offset from the chest (in the y direction which is vertical to the floor)!
-        body_points[2] << 0.0, -0.0317, 0.0;
-
-//        // use the real com as body point
-//        RigidBodyDynamics::Utils::CalcCenterOfMass(model,qinit,qdot,mass,com_temp);
-//        com_real[i] = com_temp;
-//        body_points[2] = CalcBaseToBodyCoordinates(model,qinit,body_ids[2],com_real[i]);
-        
-        //FIXME: parameter to switch fixed foot, always to false except when need to switch
-        switch_fixed = false;
-        if(i>0)//step_N) //use step_N if starting with r_sole
-        {
-          // switch when one of the feet is lifting from the ground
-          if(fabs(r_foot[i-1][2]-l_foot[i-1][2]) == 0 && fabs(r_foot[i][2]-l_foot[i][2]) > 0)
-          {
-            switch_fixed = true;
-            std::cout << "Switching fixed link at time " << t << std::endl; 
-          }
-        }
-        
-        target_pos[0] = l_foot[i];
-        target_pos[1] = r_foot[i];
-        target_pos[2] = com[i];
-        time_vec[i] = t;
-        if (!IKinematics(m_wbm, m_wbs, m_odometry, qinit, body_ids, target_pos, target_orientation, body_points, qres, switch_fixed,  step_tol, lambda, max_iter))
-        {
-            yWarning("iCubWalkingIKThread::inverseKinematics \n Inv. Kinematics for all targets \n Could not converge to a solution with the desired tolerance of %lf", step_tol);
-        }
-        
-        // Upating real com trajectory after performing inverse kinematics
-        Eigen::VectorXd tmp_com_real(3);
-        tmp_com_real << 0,0,0;
-        Eigen::VectorXd offset(3);
-        offset.setZero();
-        updateCOMreal( m_odometry, tmp_com_real, offset );
-        com_real[i] = tmp_com_real;
-        
-        // Updating real feet trajectory after performing inverse kinematics
-        Eigen::VectorXd tmp_l_foot_real(3); tmp_l_foot_real.setZero();
-        Eigen::VectorXd tmp_r_foot_real(3); tmp_r_foot_real.setZero();
-        updateFootTrajReal(m_odometry, qres.data(), tmp_l_foot_real, "l_sole");
-        updateFootTrajReal(m_odometry, qres.data(), tmp_r_foot_real, "r_sole");
-        l_foot_real[i] = tmp_l_foot_real;
-        r_foot_real[i] = tmp_r_foot_real;
-        
-        
-        res[i] = qres;
-        qinit = qres;
-        t += ts;
-        
-        double percentage = (double)i/N*100.0;
-        std::cout << "Percentage: " << int(percentage) << "% \r";
-        std::cout.flush();
+    if ( m_batchModels.empty() || !solveTrajectoryBatch(trajectory, qinit) ) {
+        IKTrajectoryChunk whole_trajectory;
+        whole_trajectory.wbm = m_wbm;
+        whole_trajectory.odometry = m_odometry;
+        whole_trajectory.warmupBegin = 0;
+        whole_trajectory.begin = 0;
+        whole_trajectory.end = N;
+        whole_trajectory.qinit = qinit;
+        whole_trajectory.print_progress = true;
+        solveTrajectoryChunk(trajectory, whole_trajectory);
     }
+    qres = res[N-1];
+    qinit = qres;
     
     // convert into degrees
     // store all the resulting configurations
@@ -490,7 +451,7 @@ void iCubWalkingIKThread::inverseKinematics(walkingParams params) {
 //     Eigen::VectorXd qres_no_fb(qres.size()-6);
 //     std::vector<Eigen::VectorXd> res_deg_cut(N,qres_no_fb);
     Eigen::VectorXd time_vec_new(N);
-    t = 0;
+    double t = 0;
     for(int i = 0; i < N; i++)
     {
         time_vec_new[i] = t;
@@ -532,6 +493,234 @@ void iCubWalkingIKThread::inverseKinematics(walkingParams params) {
 
 }
 
+void iCubWalkingIKThread::solveTrajectoryChunk(IKTrajectory &trajectory, IKTrajectoryChunk &chunk) {
+    double ts = (double) m_period/1000;
+    double step_tol = m_inverseKinematicsParams.step_tolerance;
+    double lambda   = m_inverseKinematicsParams.lambda;
+    double max_iter = m_inverseKinematicsParams.max_iter;
+
+    // IKinematics may change the body points, hence each chunk works on its own copy
+    std::vector<Eigen::Vector3d> body_points = trajectory.body_points;
+    std::vector<Eigen::Vector3d> target_pos(3);
+    Eigen::VectorXd qinit = chunk.qinit;
+    Eigen::VectorXd qres = chunk.qinit;
+
+    // Buffers of the IK solver, reused by all the samples of the chunk
+    IKWorkspace ik_workspace;
+
+    Eigen::VectorXd offset(3);
+    offset.setZero();
+    Eigen::VectorXd tmp_com_real(3);
+    Eigen::VectorXd tmp_l_foot_real(3);
+    Eigen::VectorXd tmp_r_foot_real(3);
+
+    for(int i = chunk.warmupBegin; i < chunk.end; i++)
+    {
+        //!!!!: The following line is very specific to iCub and has been figured out comparing the height of the resulting COM with the resulting joint angles from inverse kinematics against the planned COM trajectory. The exact difference has been then used to find this offset from the chest (in the y direction which is vertical to the floor)!
+        body_points[2] << 0.0, -0.0317, 0.0;
+
+        //FIXME: parameter to switch fixed foot, always to false except when need to switch
+        // The fixed foot of the first sample of the chunk is the one the odometry has been initialized with
+        bool switch_fixed = i > chunk.warmupBegin && isSwitchingFixedFoot(trajectory, i);
+        if ( switch_fixed && i >= chunk.begin ) {
+            std::cout << "Switching fixed link at time " << i*ts << std::endl;
+        }
+
+        target_pos[0] = trajectory.l_foot[i];
+        target_pos[1] = trajectory.r_foot[i];
+        target_pos[2] = trajectory.com[i];
+        if (!IKinematics(chunk.wbm, m_wbs, chunk.odometry, qinit, trajectory.body_ids, target_pos, trajectory.target_orientation, body_points, qres, switch_fixed,  step_tol, lambda, max_iter, &ik_workspace)
+            && i >= chunk.begin)
+        {
+            yWarning("iCubWalkingIKThread::inverseKinematics \n Inv. Kinematics for all targets \n Could not converge to a solution with the desired tolerance of %lf", step_tol);
+        }
+        qinit = qres;
+
+        if ( i < chunk.begin ) {
+            chunk.warmup_res.push_back(qres);
+            continue;
+        }
+
+        // Upating real com trajectory after performing inverse kinematics
+        updateCOMreal( chunk.odometry, tmp_com_real, offset );
+        trajectory.com_real[i] = tmp_com_real;
+
+        // Updating real feet trajectory after performing inverse kinematics
+        updateFootTrajReal(chunk.wbm, chunk.odometry, qres.data(), tmp_l_foot_real, "l_sole");
+        updateFootTrajReal(chunk.wbm, chunk.odometry, qres.data(), tmp_r_foot_real, "r_sole");
+        trajectory.l_foot_real[i] = tmp_l_foot_real;
+        trajectory.r_foot_real[i] = tmp_r_foot_real;
+
+        trajectory.res[i] = qres;
+
+        if ( chunk.print_progress ) {
+            double percentage = (double)(i - chunk.begin)/(chunk.end - chunk.begin)*100.0;
+            std::cout << "Percentage: " << int(percentage) << "% \r";
+            std::cout.flush();
+        }
+    }
+}
+
+bool iCubWalkingIKThread::isSwitchingFixedFoot(const IKTrajectory &trajectory, int i) {
+    // switch when one of the feet is lifting from the ground
+    return i > 0 &&
+           fabs(trajectory.r_foot[i-1][2]-trajectory.l_foot[i-1][2]) == 0 &&
+           fabs(trajectory.r_foot[i][2]-trajectory.l_foot[i][2]) > 0;
+}
+
+bool iCubWalkingIKThread::solveTrajectoryBatch(IKTrajectory &trajectory, const Eigen::VectorXd &qinit) {
+    const int N = trajectory.res.size();
+    const int nrOfChunks = m_batchModels.size() + 1;
+    const std::string &initial_fixed_link = m_odometryParams.initial_fixed_frame;
+    if ( initial_fixed_link != "l_sole" && initial_fixed_link != "r_sole" ) {
+        yWarning("iCubWalkingIKThread::solveTrajectoryBatch: the fixed frame %s is not a foot, the trajectory will be solved serially", initial_fixed_link.c_str());
+        return false;
+    }
+    if ( m_odometryParams.initial_world_reference_frame != initial_fixed_link ) {
+        yWarning("iCubWalkingIKThread::solveTrajectoryBatch: the world reference frame %s is not the fixed frame %s, the trajectory will be solved serially",
+                 m_odometryParams.initial_world_reference_frame.c_str(), initial_fixed_link.c_str());
+        return false;
+    }
+    if ( N < 2*nrOfChunks ) {
+        return false;
+    }
+
+    // Number of switches of the fixed foot up to each sample, to know which foot is fixed at the beginning of each chunk
+    std::vector<int> nrOfSwitches(N, 0);
+    for (int i = 1; i < N; i++) {
+        nrOfSwitches[i] = nrOfSwitches[i-1] + (isSwitchingFixedFoot(trajectory, i) ? 1 : 0);
+    }
+
+    // The first chunk continues from the state of m_odometry, exactly as the serial solution
+    std::vector<IKTrajectoryChunk> chunks(nrOfChunks);
+    bool ok = true;
+    for (int c = 0; c < nrOfChunks; c++) {
+        IKTrajectoryChunk &chunk = chunks[c];
+        chunk.begin = (c*N)/nrOfChunks;
+        chunk.end = ((c+1)*N)/nrOfChunks;
+        chunk.qinit = qinit;
+        chunk.print_progress = (c == 0);
+        chunk.odometry = 0;
+        if ( c == 0 ) {
+            chunk.wbm = m_wbm;
+            chunk.odometry = m_odometry;
+            chunk.warmupBegin = 0;
+            continue;
+        }
+        chunk.wbm = m_batchModels[c-1];
+        chunk.warmupBegin = std::max(0, chunk.begin - m_inverseKinematicsParams.batch_overlap);
+
+        // The odometry of the other chunks starts from the foot fixed at the beginning of the warm-up. As in threadInit, its offset is
+        // the position of the world origin in the fixed foot: the one of the serial odometry, minus the planned displacement of the
+        // fixed foot from the initial fixed foot. The world frame then coincides with the one of the serial solution, up to the
+        // tolerance with which the feet reached their targets.
+        bool left_fixed = (initial_fixed_link == "l_sole") == (nrOfSwitches[chunk.warmupBegin] % 2 == 0);
+        chunk.fixed_foot = left_fixed ? "l_sole" : "r_sole";
+        const Eigen::VectorXd &fixed_foot_pos = left_fixed ? trajectory.l_foot[chunk.warmupBegin] : trajectory.r_foot[chunk.warmupBegin];
+        const Eigen::VectorXd &initial_fixed_foot_pos = (initial_fixed_link == "l_sole") ? trajectory.l_foot[0] : trajectory.r_foot[0];
+        chunk.world_offset = KDL::Vector(m_initial_world_offset(0) - (fixed_foot_pos[0] - initial_fixed_foot_pos[0]),
+                                         m_initial_world_offset(1) - (fixed_foot_pos[1] - initial_fixed_foot_pos[1]),
+                                         m_initial_world_offset(2) - (fixed_foot_pos[2] - initial_fixed_foot_pos[2]));
+        chunk.odometry = new floatingBaseOdometry(chunk.wbm);
+        if ( !chunk.odometry->init(chunk.fixed_foot, chunk.fixed_foot, m_odometryParams.floating_base, chunk.world_offset) ) {
+            yError("iCubWalkingIKThread::solveTrajectoryBatch: could not initialize the odometry of chunk %d", c);
+            ok = false;
+        }
+    }
+
+    std::vector<IKChunkSolver*> solvers;
+    std::vector<int> notStartedChunks;
+    if ( ok ) {
+        yInfo("Solving the inverse kinematics in %d chunks of about %d samples, warm-started with %d samples", nrOfChunks, N/nrOfChunks, m_inverseKinematicsParams.batch_overlap);
+        for (int c = 1; c < nrOfChunks; c++) {
+            IKChunkSolver * solver = new IKChunkSolver(*this, trajectory, chunks[c]);
+            if ( !solver->start() ) {
+                yWarning("iCubWalkingIKThread::solveTrajectoryBatch: could not start the thread of chunk %d, it will be solved after the first one", c);
+                delete solver;
+                notStartedChunks.push_back(c);
+                continue;
+            }
+            solvers.push_back(solver);
+        }
+
+        solveTrajectoryChunk(trajectory, chunks[0]);
+        for (size_t k = 0; k < notStartedChunks.size(); k++) {
+            solveTrajectoryChunk(trajectory, chunks[notStartedChunks[k]]);
+        }
+
+        for (size_t k = 0; k < solvers.size(); k++) {
+            solvers[k]->join();
+            delete solvers[k];
+        }
+
+        // Stitch the chunks: across the warm-up samples the solution moves linearly from the previous chunk to this one.
+        // The seams are processed in order, so the previous samples already hold the stitched solution.
+        Eigen::VectorXd offset(3);
+        offset.setZero();
+        Eigen::VectorXd tmp_com_real(3);
+        Eigen::VectorXd tmp_l_foot_real(3);
+        Eigen::VectorXd tmp_r_foot_real(3);
+        for (int c = 1; c < nrOfChunks && ok; c++) {
+            IKTrajectoryChunk &chunk = chunks[c];
+            int overlap = chunk.begin - chunk.warmupBegin;
+            if ( overlap == 0 ) {
+                yWarning("iCubWalkingIKThread::solveTrajectoryBatch: batch_overlap is 0, the trajectory is discontinuous at sample %d", chunk.begin);
+                continue;
+            }
+
+            // The real COM and feet trajectories are the forward kinematics of the blended configurations, computed by
+            // an odometry that starts as the one of the chunk and replays its switches of the fixed foot
+            floatingBaseOdometry * odometry = new floatingBaseOdometry(chunk.wbm);
+            if ( !odometry->init(chunk.fixed_foot, chunk.fixed_foot, m_odometryParams.floating_base, chunk.world_offset) ) {
+                yError("iCubWalkingIKThread::solveTrajectoryBatch: could not initialize the odometry to stitch chunk %d", c);
+                delete odometry;
+                ok = false;
+                break;
+            }
+
+            double seam_difference = (chunk.warmup_res[overlap-1] - trajectory.res[chunk.begin-1]).cwiseAbs().maxCoeff();
+            for (int k = 0; k < overlap; k++) {
+                int i = chunk.warmupBegin + k;
+                double alpha = (double)(k + 1)/(overlap + 1);
+                trajectory.res[i] = (1.0 - alpha)*trajectory.res[i] + alpha*chunk.warmup_res[k];
+
+                // As in IKinematics, the fixed foot is switched with the configuration of the previous sample
+                if ( k > 0 && isSwitchingFixedFoot(trajectory, i) ) {
+                    odometry->update(trajectory.res[i-1].data(), true);
+                }
+                odometry->update(trajectory.res[i].data(), false);
+
+                updateCOMreal( odometry, tmp_com_real, offset );
+                updateFootTrajReal(chunk.wbm, odometry, trajectory.res[i].data(), tmp_l_foot_real, "l_sole");
+                updateFootTrajReal(chunk.wbm, odometry, trajectory.res[i].data(), tmp_r_foot_real, "r_sole");
+                trajectory.com_real[i] = tmp_com_real;
+                trajectory.l_foot_real[i] = tmp_l_foot_real;
+                trajectory.r_foot_real[i] = tmp_r_foot_real;
+            }
+            delete odometry;
+            yInfo("Seam at sample %d: largest joint difference from the previous chunk %lf, blended over %d samples", chunk.begin, seam_difference, overlap);
+        }
+    }
+
+    for (int c = 1; c < nrOfChunks; c++) {
+        if ( chunks[c].odometry ) {
+            delete chunks[c].odometry;
+            chunks[c].odometry = 0;
+        }
+    }
+    return ok;
+}
+
+iCubWalkingIKThread::IKChunkSolver::IKChunkSolver(iCubWalkingIKThread& owner, IKTrajectory& trajectory, IKTrajectoryChunk& chunk) :
+m_owner(owner),
+m_trajectory(trajectory),
+m_chunk(chunk)
+{ }
+
+void iCubWalkingIKThread::IKChunkSolver::run() {
+    m_owner.solveTrajectoryChunk(m_trajectory, m_chunk);
+}
+
 #pragma mark -
 #pragma mark Helper and diagnosis methods
 bool iCubWalkingIKThread::computeCenterBetweenFeet(KDL::Vector &v, std::string ref_frame) {
@@ -567,14 +756,14 @@ bool iCubWalkingIKThread::updateCOMreal(floatingBaseOdometry * odometry, Eigen::
     return true;
 }
 
-bool iCubWalkingIKThread::updateFootTrajReal(floatingBaseOdometry * odometry, double * q, Eigen::VectorXd &foot_real, std::string which_foot) {
+bool iCubWalkingIKThread::updateFootTrajReal(yarpWbi::yarpWholeBodyModel * wbm, floatingBaseOdometry * odometry, double * q, Eigen::VectorXd &foot_real, std::string which_foot) {
     wbi::Frame world_H_floatingbase;
     odometry->get_world_H_floatingbase(world_H_floatingbase);
     // Retrieve rototranslation from <which_foot> to <root>
     int foot_index;
     wbi::Frame floatingbase_H_foot;
-    m_wbm->getFrameList().idToIndex(which_foot.c_str(), foot_index);
-    m_wbm->computeH(q, wbi::Frame(), foot_index, floatingbase_H_foot);
+    wbm->getFrameList().idToIndex(which_foot.c_str(), foot_index);
+    wbm->computeH(q, wbi::Frame(), foot_index, floatingbase_H_foot);
     // Compose rototranslations to express foot trajectory in world reference frame
     wbi::Frame world_H_foot;
     world_H_foot = world_H_floatingbase*floatingbase_H_foot;
@@ -21,21 +21,24 @@
 #include <Eigen/Core>
 
 
-namespace iCub {
-    namespace ctrl {
-        class minJerkTrajGen;
-    }
-}
-
-namespace yarp {
-    namespace sig {
-        class Vector;
-    }
-}
-
 namespace codyco {
     namespace torquebalancing {
         
+        /** @brief Minimum jerk filter of a reference signal
+         *
+         * Each time a new set point is received a minimum jerk (quintic polynomial) trajectory
+         * is planned, starting from the current state of the filter (position, velocity and acceleration)
+         * and reaching the set point with zero velocity and acceleration after the specified duration.
+         * The trajectory is then evaluated in closed form at each sample time.
+         * All the buffers are allocated at construction time.
+         *
+         * @note This is not the same reference as the one of iCub::ctrl::minJerkTrajGen, used before.
+         * That third order LTI filter approaches the set point asymptotically (90% of a step after the duration,
+         * settling after about 1.5 times the duration) and its state evolves continuously with the input.
+         * Here instead the set point is reached exactly after the duration, and every change of the set point
+         * starts a new trajectory of the full duration. Position, velocity and acceleration stay continuous
+         * across a replan, but the jerk does not, and a set point changing at every sample is replanned at every sample.
+         */
         class MinimumJerkTrajectoryGenerator : public ReferenceFilter {
         public:
             MinimumJerkTrajectoryGenerator(int dimension);
@@ -59,18 +62,21 @@ namespace codyco {
             virtual const Eigen::VectorXd& getComputedSecondDerivativeValue();
 
         private:
+            void evaluateTrajectory();
             
             int m_size;
-            iCub::ctrl::minJerkTrajGen* m_minimumJerkGenerator;
             Eigen::VectorXd m_computedPosition;
             Eigen::VectorXd m_computedVelocity;
             Eigen::VectorXd m_computedAcceleration;
             
             double m_sampleTime;
             double m_duration;
-            
-            yarp::sig::Vector* m_yarpReference;
-            yarp::sig::Vector* m_yarpInitialValue;
+
+            Eigen::VectorXd m_setPoint;
+            Eigen::VectorXd m_displacement; /*!< set point minus initial position of the trajectory */
+            Eigen::Matrix<double, Eigen::Dynamic, 6> m_coefficients; /*!< size x 6. Coefficients of the polynomials, from order 0 to 5 */
+            Eigen::Matrix<double, 6, 1> m_timePowers;
+            double m_elapsedTime; /*!< time elapsed since the beginning of the current trajectory */
         };
     }
 }
@@ -26,11 +26,13 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 #include <Eigen/LU>
+#include <Eigen/Cholesky>
 
 #include <map>
 
 #include <yarp/os/BufferedPort.h>
 #include <yarp/sig/Vector.h>
+#include <ctrlLibRT/timing.h>
 
 namespace wbi {
     class wholeBodyInterface;
@@ -167,8 +169,44 @@ namespace codyco {
             
             const Eigen::VectorXd& outputTorques();
 
-            
+#pragma mark - Timing statistics
+
+            /** Opens the port on which the timing statistics of the control loop are published
+             *
+             * The port streams (approximately every second) a vector containing, for each phase
+             * of the loop (readReferences, updateRobotState, computeContactForces, computeTorques,
+             * writeTorques) and then for the whole cycle, the last duration, the 50th percentile,
+             * the 99th percentile and the maximum (in seconds), followed by the number of cycles,
+             * the number of cycles longer than the thread period and the worst cycle duration
+             * since the previous publication.
+             * @note this function must be called before the initialization of the thread
+             * @param portName the name of the port
+             * @return true if the port is successfully opened
+             */
+            bool openTimingStatisticsPort(const std::string& portName);
+
+            /** Returns the timing statistics of the control loop in a human readable form
+             * @return the timing statistics
+             */
+            std::string timingStatisticsString();
+
+            /** Resets the timing statistics of the control loop
+             */
+            void resetTimingStatistics();
+
         private:
+            /** Phases of the run method, as timed by the timing recorder */
+            enum ControlLoopPhase {
+                ControlLoopPhaseReadReferences = 0,
+                ControlLoopPhaseUpdateRobotState,
+                ControlLoopPhaseComputeContactForces,
+                ControlLoopPhaseComputeTorques,
+                ControlLoopPhaseWriteTorques,
+                ControlLoopPhaseCount
+            };
+
+            void publishTimingStatistics(double cycleDuration);
+
             void readReferences();
             bool jointsInLimitRange();
             bool updateRobotState();
@@ -238,7 +276,6 @@ namespace codyco {
             //variables used in computation.
             Eigen::MatrixXd m_centroidalForceMatrix; /*!< 6 x 12 */
             Eigen::VectorXd m_gravityForce; /*!< 6 */
-            Eigen::MatrixXd m_torquesSelector; /*!< totalDOFs x actuatedDOFs */
             //pseuo inverses
             Eigen::MatrixXd m_pseudoInverseOfJcMInvSt; /*!< actuatedDOFs x (6x2) */
             Eigen::MatrixXd m_nullSpaceProjectorOfJcMInvSt; /*!< actuatedDOFs x actuatedDOFs */
@@ -264,24 +301,33 @@ namespace codyco {
             struct Buffers {
                 Buffers(int actuatedDOFs);
                 
-                Eigen::VectorXd baseAndJointsVector;
                 Eigen::VectorXd jointsVector;
                 Eigen::VectorXd jointsVector2;
                 Eigen::VectorXd esaVector;
 
-                Eigen::MatrixXd totalDoFsIdentity;
-                Eigen::MatrixXd totalDoFsTimesTotalDoFs;
-                Eigen::LDLT<Eigen::MatrixXd::PlainObject> totalDoFsLDLTDecomposition;
-                Eigen::MatrixXd twelveTimesTotalDoFs;
-                Eigen::MatrixXd sixTimesSix;
+                Eigen::VectorXd twelveVector;
+
+                Eigen::LDLT<Eigen::MatrixXd::PlainObject> totalDoFsLDLTDecomposition; /*!< of the mass matrix */
+                Eigen::LLT<Eigen::MatrixXd::PlainObject> sixLLTDecomposition; /*!< of the base block of the mass matrix */
+                Eigen::MatrixXd totalDoFsTimesTwelve;
+                Eigen::MatrixXd sixTimesDoFs;
                 Eigen::MatrixXd twelveTimesDoFs;
-                Eigen::MatrixXd dofsTimesSix;
-                Eigen::MatrixXd dofsTimesDoFs;
+                Eigen::MatrixXd dofsTimesTwelve;
+                Eigen::MatrixXd dofsTimesTwelve2;
                 Eigen::MatrixXd twelveTimesTwelve;
 
             } m_buffers;
 
             yarp::os::BufferedPort<yarp::sig::Vector> debugPort;
+
+            //timing statistics
+            iCub::ctrl::realTime::PipelineTimingRecorder m_timingRecorder;
+            yarp::os::BufferedPort<yarp::sig::Vector> m_timingStatisticsPort;
+            yarp::sig::Vector m_timingStatistics;
+            int m_timingPublishingDecimation;
+            int m_cyclesSinceLastTimingPublishing;
+            double m_cycleStartTime;
+            double m_worstCycleDurationInWindow; /*!< worst cycle duration since the last publication */
         };
     }
 }
@@ -20,7 +20,6 @@
 namespace codyco {
     namespace torquebalancing {
         extern const double PseudoInverseTolerance;
-        extern const double JcMInvSPseudoInverseDampingTerm;
     }
 }
 
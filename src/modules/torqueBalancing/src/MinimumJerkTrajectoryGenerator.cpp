@@ -15,43 +15,32 @@
  */
 
 #include "MinimumJerkTrajectoryGenerator.h"
-#include <iCub/ctrl/minJerkCtrl.h>
-#include <yarp/sig/Vector.h>
 
 namespace codyco {
     namespace torquebalancing {
         
         MinimumJerkTrajectoryGenerator::MinimumJerkTrajectoryGenerator(int dimension)
         : m_size(dimension)
-        , m_minimumJerkGenerator(0)
         , m_computedPosition(m_size)
         , m_computedVelocity(m_size)
         , m_computedAcceleration(m_size)
         , m_sampleTime(0.01)
         , m_duration(1)
-        , m_yarpReference(0)
-        , m_yarpInitialValue(0)
+        , m_setPoint(m_size)
+        , m_displacement(m_size)
+        , m_coefficients(m_size, 6)
+        , m_elapsedTime(0)
         {
-            m_minimumJerkGenerator = new iCub::ctrl::minJerkTrajGen(m_size, m_sampleTime, m_duration); //fake parameters for time and duration. They are reset on the initializeTimeParameter method
-            m_yarpReference = new yarp::sig::Vector(m_size);
-            m_yarpInitialValue = new yarp::sig::Vector(m_size);
+            m_computedPosition.setZero();
+            m_computedVelocity.setZero();
+            m_computedAcceleration.setZero();
+            m_setPoint.setZero();
+            m_displacement.setZero();
+            m_coefficients.setZero();
+            m_timePowers.setZero();
         }
         
-        MinimumJerkTrajectoryGenerator::~MinimumJerkTrajectoryGenerator()
-        {
-            if (m_minimumJerkGenerator) {
-                delete m_minimumJerkGenerator;
-                m_minimumJerkGenerator = 0;
-            }
-            if (m_yarpReference) {
-                delete m_yarpReference;
-                m_yarpReference = 0;
-            }
-            if (m_yarpInitialValue) {
-                delete m_yarpInitialValue;
-                m_yarpInitialValue = 0;
-            }
-        }
+        MinimumJerkTrajectoryGenerator::~MinimumJerkTrajectoryGenerator() {}
         
         ReferenceFilter* MinimumJerkTrajectoryGenerator::clone() const
         {
@@ -63,13 +52,10 @@ namespace codyco {
         bool MinimumJerkTrajectoryGenerator::initializeTimeParameters(double sampleTime,
                                                                       double duration)
         {
-            if (!m_minimumJerkGenerator) return false;
+            if (sampleTime <= 0 || duration <= 0) return false;
             m_sampleTime = sampleTime;
             m_duration = duration;
-            bool result;
-            result = m_minimumJerkGenerator->setT(duration);
-            result = result && m_minimumJerkGenerator->setTs(sampleTime);
-            return result;
+            return true;
         }
         
         bool MinimumJerkTrajectoryGenerator::computeReference(const Eigen::VectorXd& setPoint,
@@ -77,67 +63,80 @@ namespace codyco {
                                                               double /*initialTime*/,
                                                               bool initFilter)
         {
-            if (!m_minimumJerkGenerator || !m_yarpReference || !m_yarpInitialValue) return false;
             if (setPoint.size() != m_size || currentValue.size() != m_size) return false;
-            
-            for (int i = 0; i < m_size; i++) {
-                (*m_yarpReference)(i) = setPoint(i);
-                (*m_yarpInitialValue)(i) = currentValue(i);
-            }
+
             if (initFilter) {
-                m_minimumJerkGenerator->init(*m_yarpInitialValue);
+                m_computedPosition = currentValue;
+                m_computedVelocity.setZero();
+                m_computedAcceleration.setZero();
+            } else if (setPoint == m_setPoint) {
+                //same set point: keep following the current trajectory
+                return true;
             }
+            m_setPoint = setPoint;
+
+            //Plan the quintic polynomial from the current state of the filter
+            //to the set point, with zero final velocity and acceleration
+            const double T = m_duration;
+            const double T2 = T * T;
+            const double T3 = T2 * T;
+            m_displacement = m_setPoint - m_computedPosition;
+
+            m_coefficients.col(0) = m_computedPosition;
+            m_coefficients.col(1) = m_computedVelocity;
+            m_coefficients.col(2) = 0.5 * m_computedAcceleration;
+            m_coefficients.col(3) = (20.0 * m_displacement - 12.0 * T * m_computedVelocity - 3.0 * T2 * m_computedAcceleration) / (2.0 * T3);
+            m_coefficients.col(4) = (-30.0 * m_displacement + 16.0 * T * m_computedVelocity + 3.0 * T2 * m_computedAcceleration) / (2.0 * T3 * T);
+            m_coefficients.col(5) = (12.0 * m_displacement - 6.0 * T * m_computedVelocity - T2 * m_computedAcceleration) / (2.0 * T3 * T2);
+            m_elapsedTime = 0;
+
             return true;
         }
 
         bool MinimumJerkTrajectoryGenerator::updateTrajectoryForCurrentTime(double /*currentTime*/)
         {
-            if (!m_minimumJerkGenerator || !m_yarpReference) return false;
-
-            m_minimumJerkGenerator->computeNextValues(*m_yarpReference);
+            //as the previous (discrete time) implementation, the filter advances by one sample at each call
+            m_elapsedTime += m_sampleTime;
+            evaluateTrajectory();
             return true;
         }
 
-        const Eigen::VectorXd& MinimumJerkTrajectoryGenerator::getComputedValue()
+        void MinimumJerkTrajectoryGenerator::evaluateTrajectory()
         {
-            if (!m_minimumJerkGenerator || !m_yarpReference) {
-                m_computedPosition.setZero();
-            } else {
-                const yarp::sig::Vector &yarpPosition = m_minimumJerkGenerator->getPos();
-                for (int i = 0; i < m_size; i++) {
-                    m_computedPosition(i) = yarpPosition(i);
-                }
+            if (m_elapsedTime >= m_duration) {
+                m_computedPosition = m_setPoint;
+                m_computedVelocity.setZero();
+                m_computedAcceleration.setZero();
+                return;
             }
-            return m_computedPosition;
 
+            const double t = m_elapsedTime;
+            const double t2 = t * t;
+            const double t3 = t2 * t;
+
+            m_timePowers << 1.0, t, t2, t3, t2 * t2, t3 * t2;
+            m_computedPosition.noalias() = m_coefficients * m_timePowers;
+
+            m_timePowers << 0.0, 1.0, 2.0 * t, 3.0 * t2, 4.0 * t3, 5.0 * t2 * t2;
+            m_computedVelocity.noalias() = m_coefficients * m_timePowers;
+
+            m_timePowers << 0.0, 0.0, 2.0, 6.0 * t, 12.0 * t2, 20.0 * t3;
+            m_computedAcceleration.noalias() = m_coefficients * m_timePowers;
+        }
+
+        const Eigen::VectorXd& MinimumJerkTrajectoryGenerator::getComputedValue()
+        {
+            return m_computedPosition;
         }
 
         const Eigen::VectorXd& MinimumJerkTrajectoryGenerator::getComputedDerivativeValue()
         {
-            if (!m_minimumJerkGenerator || !m_yarpReference) {
-                m_computedVelocity.setZero();
-            } else {
-                const yarp::sig::Vector &yarpVelocity = m_minimumJerkGenerator->getVel();
-                for (int i = 0; i < m_size; i++) {
-                    m_computedVelocity(i) = yarpVelocity(i);
-                }
-            }
             return m_computedVelocity;
-
         }
 
         const Eigen::VectorXd& MinimumJerkTrajectoryGenerator::getComputedSecondDerivativeValue()
         {
-            if (!m_minimumJerkGenerator || !m_yarpReference) {
-                m_computedAcceleration.setZero();
-            } else {
-                const yarp::sig::Vector &yarpAcceleration = m_minimumJerkGenerator->getAcc();
-                for (int i = 0; i < m_size; i++) {
-                    m_computedAcceleration(i) = yarpAcceleration(i);
-                }
-            }
             return m_computedAcceleration;
-
         }
 
     }
@@ -24,6 +24,7 @@
 #include <yarpWholeBodyInterface/yarpWholeBodyInterface.h>
 #include <yarp/os/LogStream.h>
 #include <yarp/os/LockGuard.h>
+#include <yarp/os/Time.h>
 #include <codyco/Utils.h>
 
 #include <iCub/ctrl/minJerkCtrl.h>
@@ -34,6 +35,7 @@
 #include <Eigen/LU>
 
 #define TORQUEBALANCING_STATEACTIVE_THRESHOLD 0.05
+#define TORQUEBALANCING_TIMING_PUBLISHING_PERIOD 1.0
 
 namespace codyco {
     namespace torquebalancing {
@@ -81,7 +83,6 @@ namespace codyco {
         , m_centroidalMomentum(6)
         , m_centroidalForceMatrix(6, 12)
         , m_gravityForce(6)
-        , m_torquesSelector(actuatedDOFs + 6, actuatedDOFs)
         , m_pseudoInverseOfJcMInvSt(actuatedDOFs, 6 * 2)
         , m_nullSpaceProjectorOfJcMInvSt(actuatedDOFs, actuatedDOFs)
         //        , m_pseudoInverseOfJcBase(6, 12)
@@ -98,21 +99,24 @@ namespace codyco {
         , m_esaZeroVector(6)
         , m_jacobianTemporary(6, actuatedDOFs + 6)
         , m_dJacobiaDqTemporary(6)
-        , m_buffers(actuatedDOFs) {}
+        , m_buffers(actuatedDOFs)
+        , m_timingPublishingDecimation(1)
+        , m_cyclesSinceLastTimingPublishing(0)
+        , m_cycleStartTime(0)
+        , m_worstCycleDurationInWindow(0) {}
 
         TorqueBalancingController::Buffers::Buffers(int actuatedDOFs)
-        : baseAndJointsVector(actuatedDOFs + 6)
-        , jointsVector(actuatedDOFs)
+        : jointsVector(actuatedDOFs)
         , jointsVector2(actuatedDOFs)
         , esaVector(6)
-        , totalDoFsIdentity(Eigen::MatrixXd::Identity(actuatedDOFs + 6, actuatedDOFs + 6))
-        , totalDoFsTimesTotalDoFs(actuatedDOFs + 6, actuatedDOFs + 6)
+        , twelveVector(12)
         , totalDoFsLDLTDecomposition(actuatedDOFs + 6)
-        , twelveTimesTotalDoFs(12, actuatedDOFs + 6)
-        , sixTimesSix(6, 6)
+        , sixLLTDecomposition(6)
+        , totalDoFsTimesTwelve(actuatedDOFs + 6, 12)
+        , sixTimesDoFs(6, actuatedDOFs)
         , twelveTimesDoFs(12, actuatedDOFs)
-        , dofsTimesSix(actuatedDOFs, 6)
-        , dofsTimesDoFs(actuatedDOFs, actuatedDOFs)
+        , dofsTimesTwelve(actuatedDOFs, 12)
+        , dofsTimesTwelve2(actuatedDOFs, 12)
         , twelveTimesTwelve(12, 12) {}
 
         TorqueBalancingController::~TorqueBalancingController() {}
@@ -137,9 +141,6 @@ namespace codyco {
             m_gravityUnitVector[0] = m_gravityUnitVector[1] = 0;
             m_gravityUnitVector[2] = -9.81;
 
-            m_torquesSelector.setZero();
-            m_torquesSelector.bottomRows(m_actuatedDOFs).setIdentity();
-
             m_jointsZeroVector.setZero();
             m_esaZeroVector.setZero();
             m_torqueSaturationLimit.setConstant(std::numeric_limits<double>::max());
@@ -201,12 +202,29 @@ namespace codyco {
 
 //            debugPort.open("/tb/debug:o");
 
+            //timing statistics
+            std::vector<std::string> phaseNames(ControlLoopPhaseCount);
+            phaseNames[ControlLoopPhaseReadReferences] = "readReferences";
+            phaseNames[ControlLoopPhaseUpdateRobotState] = "updateRobotState";
+            phaseNames[ControlLoopPhaseComputeContactForces] = "computeContactForces";
+            phaseNames[ControlLoopPhaseComputeTorques] = "computeTorques";
+            phaseNames[ControlLoopPhaseWriteTorques] = "writeTorques";
+
+            double periodInSeconds = getRate() / 1000.0;
+            m_timingRecorder.init(phaseNames, periodInSeconds);
+            m_timingRecorder.getStatistics(m_timingStatistics);
+            m_timingPublishingDecimation = static_cast<int>(TORQUEBALANCING_TIMING_PUBLISHING_PERIOD / periodInSeconds);
+            if (m_timingPublishingDecimation < 1) m_timingPublishingDecimation = 1;
+            m_cyclesSinceLastTimingPublishing = 0;
+            m_worstCycleDurationInWindow = 0;
+
             return linkFound && result && !m_activeConstraints.empty();
         }
 
         void TorqueBalancingController::threadRelease()
         {
             debugPort.close();
+            m_timingStatisticsPort.close();
         }
 
         void TorqueBalancingController::run()
@@ -214,8 +232,13 @@ namespace codyco {
             yarp::os::LockGuard guard(m_mutex);
             if (!m_active) return;
 
+            //Cycles interrupted by a deactivation are not accounted in the statistics
+            m_cycleStartTime = yarp::os::Time::now();
+            m_timingRecorder.startCycle();
+
             //read references
             readReferences();
+            m_timingRecorder.endStage(ControlLoopPhaseReadReferences);
 
             //read / update state
             if (!updateRobotState()) {
@@ -235,14 +258,71 @@ namespace codyco {
                 return;
             }
 
+            //joint limits check is accounted in the state update
+            m_timingRecorder.endStage(ControlLoopPhaseUpdateRobotState);
+
             //compute desired feet forces
             computeContactForces(m_desiredCOMAcceleration, m_desiredContactForces);
+            m_timingRecorder.endStage(ControlLoopPhaseComputeContactForces);
 
             //compute torques
             computeTorques(m_desiredContactForces, m_torques);
+            m_timingRecorder.endStage(ControlLoopPhaseComputeTorques);
 
             //write torques
             writeTorques();
+            m_timingRecorder.endStage(ControlLoopPhaseWriteTorques);
+
+            m_timingRecorder.endCycle();
+            publishTimingStatistics(yarp::os::Time::now() - m_cycleStartTime);
+        }
+
+        void TorqueBalancingController::publishTimingStatistics(double cycleDuration)
+        {
+            if (cycleDuration > m_worstCycleDurationInWindow)
+                m_worstCycleDurationInWindow = cycleDuration;
+
+            m_cyclesSinceLastTimingPublishing++;
+            if (m_cyclesSinceLastTimingPublishing < m_timingPublishingDecimation) return;
+            m_cyclesSinceLastTimingPublishing = 0;
+
+            if (m_timingStatisticsPort.getOutputCount() > 0) {
+                m_timingRecorder.getStatistics(m_timingStatistics);
+                yarp::sig::Vector &output = m_timingStatisticsPort.prepare();
+                if (output.size() != m_timingStatistics.size() + 1)
+                    output.resize(m_timingStatistics.size() + 1);
+                for (size_t i = 0; i < m_timingStatistics.size(); i++) {
+                    output[i] = m_timingStatistics[i];
+                }
+                output[m_timingStatistics.size()] = m_worstCycleDurationInWindow;
+                m_timingStatisticsPort.write();
+            }
+
+            m_worstCycleDurationInWindow = 0;
+        }
+
+#pragma mark - Timing statistics
+
+        bool TorqueBalancingController::openTimingStatisticsPort(const std::string& portName)
+        {
+            if (!m_timingStatisticsPort.open(portName.c_str())) {
+                yError("Could not open timing statistics port: %s", portName.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        std::string TorqueBalancingController::timingStatisticsString()
+        {
+            yarp::os::LockGuard guard(m_mutex);
+            return m_timingRecorder.getStatisticsString();
+        }
+
+        void TorqueBalancingController::resetTimingStatistics()
+        {
+            yarp::os::LockGuard guard(m_mutex);
+            m_timingRecorder.reset();
+            m_worstCycleDurationInWindow = 0;
         }
 
 #pragma mark - Getter and setter
@@ -578,74 +658,62 @@ namespace codyco {
             Eigen::internal::set_is_malloc_allowed(false);
 #endif
 
-            //Names are taken from "math" from brevity
-            MatrixXd JcMInv = m_contactsJacobian * m_massMatrix.inverse(); //to become instance (?)
-            MatrixXd JcMInvJct = JcMInv * m_contactsJacobian.transpose(); //to become instance (?)
-            MatrixXd JcMInvTorqueSelector = JcMInv * m_torquesSelector; //to become instance (?)
-            MatrixXd jointProjectedBaseAccelerations = m_massMatrix.block(6, 0, m_actuatedDOFs, 6) * m_massMatrix.topLeftCorner<6, 6>().inverse();
+            //Names are taken from "math" from brevity.
+            //The mass matrix (and its base block) are symmetric positive definite:
+            //they are factorized once per cycle, and all the products with their inverses are
+            //computed as solves on the transposed quantities, in the preallocated buffers.
 
-            math::dampedPseudoInverse(JcMInvTorqueSelector, m_svdDecompositionOfJcMInvSt, m_pseudoInverseOfJcMInvSt,
-                                      PseudoInverseTolerance,
-                                      JcMInvSPseudoInverseDampingTerm);
-            math::pseudoInverse(JcMInvTorqueSelector, m_svdDecompositionOfJcMInvSt,
-                                m_pseudoInverseOfJcMInvSt, PseudoInverseTolerance);
-            //TODO: change the following line by using the null space basis obtained by the pseudoinverse method
-            MatrixXd JcNullSpaceProjector = MatrixXd::Identity(m_actuatedDOFs, m_actuatedDOFs) - m_pseudoInverseOfJcMInvSt * JcMInvTorqueSelector;
+            //M^{-1} Jc^T (JcMInv is its transpose, as M is symmetric)
+            m_buffers.totalDoFsLDLTDecomposition.compute(m_massMatrix);
+            m_buffers.totalDoFsTimesTwelve = m_contactsJacobian.transpose();
+            m_buffers.totalDoFsLDLTDecomposition.solveInPlace(m_buffers.totalDoFsTimesTwelve);
 
-            MatrixXd mult_f_tau0 =  jointProjectedBaseAccelerations * m_contactsJacobian.leftCols(6).transpose() - m_contactsJacobian.rightCols(m_actuatedDOFs).transpose();
+            //JcMInvJct
+            m_buffers.twelveTimesTwelve.noalias() = m_contactsJacobian * m_buffers.totalDoFsTimesTwelve;
+            //JcMInvTorqueSelector: the torque selector just selects the joints columns of JcMInv
+            m_buffers.twelveTimesDoFs = m_buffers.totalDoFsTimesTwelve.bottomRows(m_actuatedDOFs).transpose();
 
-            VectorXd  torques0 =  m_gravityBiasTorques.tail(m_actuatedDOFs) - m_impedanceGains.asDiagonal() * (m_jointPositions - m_desiredJointsConfiguration) - jointProjectedBaseAccelerations * m_generalizedBiasForces.head<6>();
-
-            MatrixXd mult_f_tau = -m_pseudoInverseOfJcMInvSt * JcMInvJct + JcNullSpaceProjector * mult_f_tau0;
-
-            VectorXd n_tau = m_pseudoInverseOfJcMInvSt * (JcMInv * m_generalizedBiasForces - m_contactsDJacobianDq) + JcNullSpaceProjector * torques0;
+            //jointProjectedBaseAccelerations = M_{jb} M_{bb}^{-1} is the transpose of M_{bb}^{-1} M_{bj}
+            m_buffers.sixLLTDecomposition.compute(m_massMatrix.topLeftCorner<6, 6>());
+            m_buffers.sixTimesDoFs = m_massMatrix.block(0, 6, 6, m_actuatedDOFs);
+            m_buffers.sixLLTDecomposition.solveInPlace(m_buffers.sixTimesDoFs);
 
+            math::pseudoInverse(m_buffers.twelveTimesDoFs, m_svdDecompositionOfJcMInvSt,
+                                m_pseudoInverseOfJcMInvSt, PseudoInverseTolerance);
             //TODO: change the following line by using the null space basis obtained by the pseudoinverse method
-//            MatrixXd forceMatrixNullSpaceProjector = MatrixXd::Identity(12, 12) - m_pseudoInverseOfCentroidalForceMatrix * m_centroidalForceMatrix;
-
-            MatrixXd mat = mult_f_tau * m_nullSpaceOfCentroidalForceMatrix;
-
-            math::pseudoInverse(mult_f_tau * m_nullSpaceOfCentroidalForceMatrix, m_svdDecompositionOfTauN0_f,m_pseudoInverseOfTauN0_f, PseudoInverseTolerance, Eigen::ComputeFullV|Eigen::ComputeFullU);
-
-            torques = (MatrixXd::Identity(n_tau.size(), n_tau.size()) -mult_f_tau * m_nullSpaceOfCentroidalForceMatrix * m_pseudoInverseOfTauN0_f) * (n_tau + mult_f_tau * desiredContactForces);
-
-//            m_buffers.totalDoFsLDLTDecomposition.compute(m_massMatrix);
-//            Eigen::internal::solve_retval<LDLT<MatrixXd::PlainObject>, MatrixXd> var =
-//            m_buffers.totalDoFsLDLTDecomposition.solve(m_buffers.totalDoFsIdentity);
-//            m_buffers.totalDoFsTimesTotalDoFs = var.rhs();
-//
-//            m_buffers.twelveTimesTotalDoFs.noalias() = m_contactsJacobian * m_buffers.totalDoFsTimesTotalDoFs;
-//            m_buffers.twelveTimesTwelve.noalias() = m_buffers.twelveTimesTotalDoFs * m_contactsJacobian.transpose();
-//            m_buffers.sixTimesSix.noalias() = m_massMatrix.topLeftCorner<6, 6>().inverse();
-//            m_buffers.twelveTimesDoFs.noalias() = m_buffers.twelveTimesTotalDoFs * m_torquesSelector;
-//            m_buffers.dofsTimesSix.noalias() = m_massMatrix.block(6, 0, m_actuatedDOFs, 6) * m_buffers.sixTimesSix; //* m_massMatrix.topLeftCorner<6, 6>().inverse();
-//
-//            math::dampedPseudoInverse(m_buffers.twelveTimesDoFs, m_svdDecompositionOfJcMInvSt, m_pseudoInverseOfJcMInvSt,
-//                                      PseudoInverseTolerance,
-//                                      JcMInvSPseudoInverseDampingTerm);
-//            math::pseudoInverse(m_buffers.twelveTimesDoFs, m_svdDecompositionOfJcMInvSt,
-//                                m_pseudoInverseOfJcMInvSt, PseudoInverseTolerance);
-//            //TODO: change the following line by using the null space basis obtained by the pseudoinverse method
-//
-//            m_nullSpaceProjectorOfJcMInvSt.setIdentity();
-//            m_nullSpaceProjectorOfJcMInvSt/*.noalias()*/ -= m_pseudoInverseOfJcMInvSt * m_buffers.twelveTimesDoFs;
-//
-//
-//            MatrixXd mult_f_tau0 =  m_buffers.dofsTimesSix * m_contactsJacobian.leftCols(6).transpose() - m_contactsJacobian.rightCols(m_actuatedDOFs).transpose();
-//
-//            m_buffers.jointsVector =  m_gravityBiasTorques.tail(m_actuatedDOFs) - m_impedanceGains.asDiagonal() * (m_jointPositions - m_desiredJointsConfiguration) - m_buffers.dofsTimesSix * m_generalizedBiasForces.head<6>();
-//
-//            MatrixXd mult_f_tau = -m_pseudoInverseOfJcMInvSt * m_buffers.twelveTimesTwelve + m_nullSpaceProjectorOfJcMInvSt * mult_f_tau0;
-//
-//            m_buffers.jointsVector2 = m_pseudoInverseOfJcMInvSt * m_buffers.twelveTimesTotalDoFs * m_generalizedBiasForces;
-//            m_buffers.jointsVector2 -= m_pseudoInverseOfJcMInvSt * m_contactsDJacobianDq;
-//            m_buffers.jointsVector2 += m_nullSpaceProjectorOfJcMInvSt * m_buffers.jointsVector;
-//
-//            math::pseudoInverse(mult_f_tau * m_nullSpaceOfCentroidalForceMatrix, m_svdDecompositionOfTauN0_f,m_pseudoInverseOfTauN0_f, PseudoInverseTolerance, Eigen::ComputeFullV|Eigen::ComputeFullU);
-//
-//            m_buffers.dofsTimesDoFs.setIdentity();
-//
-//            torques = (m_buffers.dofsTimesDoFs - mult_f_tau * m_nullSpaceOfCentroidalForceMatrix * m_pseudoInverseOfTauN0_f) * (m_buffers.jointsVector2 + mult_f_tau * desiredContactForces);
+            m_nullSpaceProjectorOfJcMInvSt.setIdentity();
+            m_nullSpaceProjectorOfJcMInvSt.noalias() -= m_pseudoInverseOfJcMInvSt * m_buffers.twelveTimesDoFs;
+
+            //mult_f_tau0
+            m_buffers.dofsTimesTwelve.noalias() = m_buffers.sixTimesDoFs.transpose() * m_contactsJacobian.leftCols(6).transpose();
+            m_buffers.dofsTimesTwelve -= m_contactsJacobian.rightCols(m_actuatedDOFs).transpose();
+
+            //torques0
+            m_buffers.jointsVector = m_gravityBiasTorques.tail(m_actuatedDOFs) - m_impedanceGains.asDiagonal() * (m_jointPositions - m_desiredJointsConfiguration);
+            m_buffers.jointsVector.noalias() -= m_buffers.sixTimesDoFs.transpose() * m_generalizedBiasForces.head<6>();
+
+            //mult_f_tau
+            m_buffers.dofsTimesTwelve2.noalias() = -m_pseudoInverseOfJcMInvSt * m_buffers.twelveTimesTwelve;
+            m_buffers.dofsTimesTwelve2.noalias() += m_nullSpaceProjectorOfJcMInvSt * m_buffers.dofsTimesTwelve;
+
+            //n_tau
+            m_buffers.twelveVector.noalias() = m_buffers.totalDoFsTimesTwelve.transpose() * m_generalizedBiasForces;
+            m_buffers.twelveVector -= m_contactsDJacobianDq;
+            m_buffers.jointsVector2.noalias() = m_pseudoInverseOfJcMInvSt * m_buffers.twelveVector;
+            m_buffers.jointsVector2.noalias() += m_nullSpaceProjectorOfJcMInvSt * m_buffers.jointsVector;
+
+            //mult_f_tau * N (mult_f_tau0 is not needed anymore)
+            m_buffers.dofsTimesTwelve.noalias() = m_buffers.dofsTimesTwelve2 * m_nullSpaceOfCentroidalForceMatrix;
+
+            //thin U and V are enough for the pseudoinverse
+            math::pseudoInverse(m_buffers.dofsTimesTwelve, m_svdDecompositionOfTauN0_f, m_pseudoInverseOfTauN0_f, PseudoInverseTolerance, Eigen::ComputeThinU|Eigen::ComputeThinV);
+
+            //torques = (I - mult_f_tau * N * pinv(mult_f_tau * N)) * (n_tau + mult_f_tau * f),
+            //computed with matrix-vector products only
+            m_buffers.jointsVector2.noalias() += m_buffers.dofsTimesTwelve2 * desiredContactForces;
+            m_buffers.twelveVector.noalias() = m_pseudoInverseOfTauN0_f * m_buffers.jointsVector2;
+            torques = m_buffers.jointsVector2;
+            torques.noalias() -= m_buffers.dofsTimesTwelve * m_buffers.twelveVector;
 
             //apply saturation
             //TODO: this must be checked: valgrind says it contains a jump on an unitialized variable
@@ -332,6 +332,10 @@ namespace codyco {
             }
             m_controller->setDelegate(this);
             m_controller->setCheckJointLimits(checkJointLimits);
+            if (!m_controller->openTimingStatisticsPort(("/" + getName("/timing:o")).c_str())) {
+                yError("Could not open timing statistics port: /%s/timing:o", m_moduleName.c_str());
+                return false;
+            }
 
             //link controller and references variables to param helper manager
             if (!m_paramHelperManager->linkVariables()
@@ -562,6 +566,13 @@ namespace codyco {
                         if (!switchToTorqueGainsWithKey(command.get(1).asString()))
                             reply.addString(("Failed to switch to " + command.get(1).asString()).c_str());
                     }
+                } else if (command.size() == 1 && command.get(0).isString()
+                           && command.get(0).asString() == "timing_stats") {
+                    reply.addString(m_controller->timingStatisticsString().c_str());
+                } else if (command.size() == 1 && command.get(0).isString()
+                           && command.get(0).asString() == "timing_reset") {
+                    m_controller->resetTimingStatistics();
+                    reply.addString("Timing statistics reset.");
                 } else {
                     reply.addString((std::string("Command ") + command.toString().c_str() + " not recognized.").c_str());
                 }
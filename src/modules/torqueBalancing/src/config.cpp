@@ -19,6 +19,5 @@
 namespace codyco {
     namespace torquebalancing {
         const double PseudoInverseTolerance = 1e-5;
-        const double JcMInvSPseudoInverseDampingTerm = 1e-2;
     }
 }
\ No newline at end of file
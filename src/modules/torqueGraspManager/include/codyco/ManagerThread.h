@@ -160,6 +160,8 @@ namespace codyco {
          - integer: 0 => false, != 0 => true
          */
         yarp::os::RpcClient askForMotionDoneRPCClient;
+        /** performs the queries on askForMotionDoneRPCClient, without blocking the thread */
+        codyco::MotionDoneQuery motionDoneQuery;
         //End additions
 
         //Additions to support an additional "disabled" state
@@ -193,6 +195,7 @@ namespace codyco {
         double releaseTmo;
 
         double latchTimer;
+        double stopTimer;
         yarp::sig::Vector sphereCenter;
 
         yarp::sig::Vector openHandPoss, closeHandPoss;
@@ -205,6 +208,7 @@ namespace codyco {
         yarp::sig::Matrix R,Rx,Ry,Rz;
 
         int  state;
+        int  stateAfterHoming;
         bool state_breathers;
         int  startup_context_id_left;
         int  startup_context_id_right;
@@ -234,6 +238,10 @@ namespace codyco {
 
         void commandHead();
 
+        void goHome();
+
+        void doGoHome();
+
         void steerHeadToHome();
 
         void steerTorsoToHome();
@@ -20,10 +20,16 @@
 #define UTILITIES_H
 
 #include <yarp/os/Searchable.h>
+#include <yarp/os/Thread.h>
+#include <yarp/os/Semaphore.h>
+#include <yarp/os/Mutex.h>
+#include <yarp/os/RpcClient.h>
 #include <yarp/dev/all.h>
 #include <yarp/sig/Vector.h>
 #include <iCub/ctrl/neuralNetworks.h>
 
+#include <string>
+
 namespace codyco {
 
     class Predictor
@@ -38,6 +44,54 @@ namespace codyco {
     };
 
 
+    /**
+     * Thread asking if a motion is done on an RPC port, so that the caller never waits for the reply.
+     *
+     * RPC protocol: writes IS_DONE [part_name], expects an integer (0 => false, != 0 => true).
+     *
+     * The caller posts a query with ask(), and checks if the reply arrived with getReply()
+     * on its following cycles.
+     */
+    class MotionDoneQuery : public yarp::os::Thread
+    {
+    protected:
+        yarp::os::RpcClient &rpcClient;
+        yarp::os::Semaphore requestSemaphore;
+        yarp::os::Mutex mutex;
+
+        // Protected by mutex
+        std::string requestedPart;
+        unsigned int requestId;
+        bool pending;
+        bool replied;
+        bool done;
+
+    public:
+        MotionDoneQuery(yarp::os::RpcClient &_rpcClient);
+
+        /**
+         * Post a query for the part (all the parts if empty).
+         * @return false if a query is already pending (and no new query is posted), true otherwise.
+         */
+        bool ask(const std::string &part="");
+
+        /**
+         * Get the reply of the pending query, if it arrived.
+         * @return true if the reply arrived (and the query is no more pending), false otherwise.
+         */
+        bool getReply(bool &motionDone);
+
+        /**
+         * Forget the pending query: its reply, if it arrives, is discarded.
+         */
+        void cancel();
+
+        void run();
+
+        void onStop();
+    };
+
+
     class myReport : public yarp::os::SearchMonitor
     {
     protected:
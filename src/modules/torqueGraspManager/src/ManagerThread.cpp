@@ -32,9 +32,15 @@ using namespace iCub::ctrl;
 #define STATE_CHECKMOTIONDONE   2
 #define STATE_RELEASE           3
 #define STATE_WAIT              4
+#define STATE_GOHOME            5
+#define STATE_CHANGEARM         6
+
+// time given to the controllers to process the stop command, before sending the new references [s]
+#define STOP_SETTLE_TIME        0.1
 
 namespace codyco {
 
+    // Blocking query, to be used only when motionDoneQuery is not running
     void ManagerThread::checkMotionDone(bool &done, std::string part)
     {
         Bottle response;
@@ -441,22 +447,38 @@ namespace codyco {
                 fprintf(stdout,"--- Disabling requested => DISABLED\n");
             }
 
-            steerHeadToHome();
-            stopControl();
-            steerTorsoToHome();
-            steerArmToHome(LEFTARM);
-            steerArmToHome(RIGHTARM);
+            stateAfterHoming=disablingRequested?STATE_DISABLED:STATE_IDLE;
+            goHome();
+        }
+    }
 
-            wentHome=true;
-            deleteGuiTarget();
-            if( !disablingRequested )
-            {
-                state=STATE_IDLE;
-            }
-            else
+    void ManagerThread::goHome()
+    {
+        // the torso and the arms are steered home by doGoHome,
+        // once the stop command has been processed
+        steerHeadToHome();
+        stopControl();
+
+        wentHome=true;
+        state=STATE_GOHOME;
+    }
+
+    void ManagerThread::doGoHome()
+    {
+        if (state==STATE_GOHOME)
+        {
+            if ((Time::now()-stopTimer)>STOP_SETTLE_TIME)
             {
-                state=STATE_DISABLED;
-                disablingRequested = false;
+                steerTorsoToHome();
+                steerArmToHome(LEFTARM);
+                steerArmToHome(RIGHTARM);
+
+                deleteGuiTarget();
+                state=stateAfterHoming;
+                if (state==STATE_DISABLED)
+                {
+                    disablingRequested = false;
+                }
             }
         }
     }
@@ -512,7 +534,7 @@ namespace codyco {
 
     void ManagerThread::commandHead()
     {
-        if (state == STATE_DISABLED) return;
+        if (state == STATE_DISABLED || state == STATE_GOHOME) return;
 
         if (state!=STATE_IDLE)
         {
@@ -789,12 +811,19 @@ namespace codyco {
                     fprintf(stdout,"*** Change arm event triggered\n");
                     state=STATE_CHECKMOTIONDONE;
                     latchTimer=Time::now();
+                    motionDoneQuery.cancel();
+                    motionDoneQuery.ask();
                 }
             }
             else if (state==STATE_CHECKMOTIONDONE)
             {
-                bool done;
-                checkMotionDone(done);
+                // the reply is polled on the following cycles, asking again until the motion is done
+                bool done=false;
+                if (!motionDoneQuery.getReply(done) || !done)
+                {
+                    motionDoneQuery.ask();
+                }
+
                 if (!done)
                 {
                     if (Time::now()-latchTimer>3.0*trajTime)
@@ -806,7 +835,15 @@ namespace codyco {
 
                 if (done)
                 {
+                    motionDoneQuery.cancel();
                     stopControl();
+                    state=STATE_CHANGEARM;
+                }
+            }
+            else if (state==STATE_CHANGEARM)
+            {
+                if ((Time::now()-stopTimer)>STOP_SETTLE_TIME)
+                {
                     steerArmToHome();
 
                     // swap interfaces
@@ -1067,7 +1104,8 @@ namespace codyco {
             output.put((armSel == LEFTARM ? "left_arm" : "right_arm"), armBottle.get(0));
             desiredJointConfigurationPort.write(true);
 
-            Time::delay(0.1);
+            // the new references are sent STOP_SETTLE_TIME after stopTimer
+            stopTimer=Time::now();
         }
     }
 
@@ -1199,7 +1237,10 @@ namespace codyco {
     , drvTorso(0), drvHead(0), drvLeftArm(0), drvRightArm(0)
     , drvCartLeftArm(0), drvCartRightArm(0), drvGazeCtrl(0)
     , desiredJointConfiguration(0), currentDesiredArmJointConfiguration(0), currentArmCurrentPosition(0)
+    , motionDoneQuery(askForMotionDoneRPCClient)
     , disablingRequested(false)
+    , stopTimer(0.0)
+    , stateAfterHoming(STATE_IDLE)
     {}
 
     bool ManagerThread::threadInit()
@@ -1516,6 +1557,7 @@ namespace codyco {
         // steer the robot to the initial configuration
         steerHeadToHome();
         stopControl();
+        Time::delay(STOP_SETTLE_TIME);
         steerTorsoToHome();
         steerArmToHome(LEFTARM);
         steerArmToHome(RIGHTARM);
@@ -1527,6 +1569,13 @@ namespace codyco {
         state=STATE_IDLE;
         state_breathers=true;
 
+        if (!motionDoneQuery.start())
+        {
+            fprintf(stdout,"--- Unable to start the motion done query thread\n");
+            close();
+            return false;
+        }
+
         return true;
     }
 
@@ -1535,6 +1584,7 @@ namespace codyco {
         yarp::os::LockGuard guard(this->runMutex);
 
         getSensorData();
+        doGoHome();
         doIdle();
         commandHead();
         selectArm();
@@ -1548,8 +1598,12 @@ namespace codyco {
 
     void ManagerThread::threadRelease()
     {
+        // from now on the motion done queries are blocking
+        motionDoneQuery.stop();
+
         steerHeadToHome();
         stopControl();
+        Time::delay(STOP_SETTLE_TIME);
         steerTorsoToHome();
         steerArmToHome(LEFTARM);
         steerArmToHome(RIGHTARM);
@@ -1609,6 +1663,12 @@ namespace codyco {
         {
             state=STATE_IDLE;
         }
+        else if( state==STATE_GOHOME && stateAfterHoming==STATE_DISABLED )
+        {
+            // the robot is going home to be disabled: stay enabled
+            stateAfterHoming=STATE_IDLE;
+            disablingRequested=false;
+        }
     }
     
     void ManagerThread::disableGrasping()
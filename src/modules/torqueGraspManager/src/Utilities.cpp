@@ -2,6 +2,7 @@
 
 #include <yarp/os/Property.h>
 #include <yarp/os/Bottle.h>
+#include <yarp/os/LockGuard.h>
 #include <yarp/sig/Vector.h>
 
 using namespace yarp::os;
@@ -37,6 +38,91 @@ namespace codyco {
         return net.predict(in);
     }
 
+    MotionDoneQuery::MotionDoneQuery(RpcClient &_rpcClient)
+    : rpcClient(_rpcClient)
+    , requestSemaphore(0)
+    , requestId(0)
+    , pending(false)
+    , replied(false)
+    , done(false)
+    {}
+
+    bool MotionDoneQuery::ask(const std::string &part)
+    {
+        {
+            LockGuard guard(mutex);
+            if (pending)
+                return false;
+
+            requestedPart=part;
+            requestId++;
+            pending=true;
+            replied=false;
+        }
+
+        requestSemaphore.post();
+        return true;
+    }
+
+    bool MotionDoneQuery::getReply(bool &motionDone)
+    {
+        LockGuard guard(mutex);
+        if (!pending || !replied)
+            return false;
+
+        motionDone=done;
+        pending=false;
+        replied=false;
+        return true;
+    }
+
+    void MotionDoneQuery::cancel()
+    {
+        LockGuard guard(mutex);
+        // the id of the cancelled query is not used by any other query
+        requestId++;
+        pending=false;
+        replied=false;
+    }
+
+    void MotionDoneQuery::run()
+    {
+        while (!isStopping())
+        {
+            requestSemaphore.wait();
+            if (isStopping())
+                break;
+
+            Bottle command, response;
+            unsigned int id;
+            {
+                LockGuard guard(mutex);
+                if (!pending)
+                    continue;
+
+                command.addString("IS_DONE");
+                if (requestedPart.length() > 0)
+                    command.addString(requestedPart);
+                id=requestId;
+            }
+
+            rpcClient.write(command, response);
+            Value value = response.pop();
+
+            LockGuard guard(mutex);
+            if (pending && (id==requestId))
+            {
+                done = value.isInt() && (value.asInt() != 0);
+                replied=true;
+            }
+        }
+    }
+
+    void MotionDoneQuery::onStop()
+    {
+        requestSemaphore.post();
+    }
+
     void myReport::report(const SearchReport& report, const char *context)
     {
         std::string ctx=context;
@@ -15,6 +15,7 @@
 #include <deque>
 
 #include "constants.h"
+#include "trajectoryTable.h"
 
 
 // ******************** ACTION CLASS
@@ -33,9 +34,11 @@ struct actionStruct
 
 struct actionStructForTorqueBalancing
 {
-    std::deque< std::deque<double> >  com_traj;
-    std::deque< std::deque<double> >  postural_traj;
-    std::deque< std::deque<double> >     constraints;
+    trajectoryTable  com_traj;
+    trajectoryTable  postural_traj;
+    trajectoryTable  constraints;
+    // Row of the trajectories to be streamed next
+    size_t           current_sample;
     
 public:
     actionStructForTorqueBalancing();
@@ -58,9 +61,20 @@ class actionClass
       * \param filename Name of the txt file without the _left or _right suffix. E.g. seq02_leg
 
       * This method opens a file with a sequence of lines defining a walking trajectory.
-      * For each limb of the robot involved in the trajectory a file must be created, e.g. seq02_leg_left.txt would be the sequence file for the left leg. The same must be done for every limb involved in the trajectory and filename corresponds to the suffix seq02_leg. This method is used when param filename2 is passed to the walkPlayer module. */
+      * For each limb of the robot involved in the trajectory a file must be created, e.g. seq02_leg_left.txt would be the sequence file for the left leg. The same must be done for every limb involved in the trajectory and filename corresponds to the suffix seq02_leg. This method is used when param filename2 is passed to the walkPlayer module.
+      * When the binary versions of all the files (e.g. seq02_leg_left.bin, see convertToBinary()) are found, they are loaded instead of the text files,
+      * unless one of the text files has been modified after its conversion. */
     bool openFile(std::string filename, yarp::os::ResourceFinder &rf);
 
+    /** \brief Converts a text sequence file to the binary format of trajectoryTable.
+     *  \param filenamePrefix Prefix of the file, e.g. seq02_leg or torqueBalancing.
+     *  \param filenameSuffix Suffix of the file, e.g. left or comTraj.
+     *  \param rf             Reference to the resourceFinder object used to find the text file.
+     *
+     *  The binary file is written next to the text file, with extension .bin instead of .txt, and it is
+     *  loaded instead of the text file by openFile() and openTorqueBalancingSequence() as long as it is not older than the text file. */
+    static bool convertToBinary(std::string filenamePrefix, std::string filenameSuffix, yarp::os::ResourceFinder &rf);
+
     /**
      *  Opens and parses a trajectory file specific for the torqueBalancing. When this file is
      *  specified, this module will simply stream these trajectories through ports. Therefore,
@@ -87,6 +101,7 @@ class actionClass
                                      std::string formatConstraintsTraj = "");
     /**
      *  Reads already existing trajectory files to be used by torqueBalancing and stores the retrieved com, postural and constraints trajectories in variable action_vector_torqueBalancing.
+     *  The binary version of the file (e.g. torqueBalancing_comTraj.bin) is memory mapped instead of parsing the text file when it is found and it is not older than the text file.
      *
      *  @param filenamePrefix Prefix of the existing files e.g. the part torqueBalancing in torqueBalancing_comTraj.txt.
      *  @param filenameSuffix Suffix of the existing files e.g. the part comTraj in torqueBalancing_comTraj.txt.
@@ -0,0 +1,85 @@
+#ifndef TRAJECTORYTABLE_H
+#define TRAJECTORYTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+
+// ******************** TRAJECTORY TABLE
+/**
+ *  Table of doubles with one row for each sample of a trajectory, stored by columns in a contiguous array.
+ *
+ *  A table can be read from the text sequence files (one sample per line, values separated by spaces, tabs
+ *  or commas) or from its binary version, that is memory mapped instead of being parsed. The binary file
+ *  is made of a trajectoryTableHeader followed by the columns, each one containing the nrOfRows values
+ *  of a column as native doubles.
+ */
+class trajectoryTable
+{
+    public:
+    /**
+     *  Header of the binary trajectory files.
+     */
+    struct trajectoryTableHeader
+    {
+        char     magic[8];      // TRAJECTORY_TABLE_MAGIC
+        uint32_t version;       // TRAJECTORY_TABLE_VERSION
+        uint32_t byteOrder;     // TRAJECTORY_TABLE_BYTE_ORDER as written by the machine that created the file
+        uint64_t nrOfRows;
+        uint64_t nrOfColumns;
+    };
+
+    trajectoryTable();
+    ~trajectoryTable();
+
+    /** \brief Parses a text sequence file.
+     *  \param filename Path of the file. Empty lines are skipped, all the other lines must have the same number of values.
+     */
+    bool readText(const std::string &filename);
+
+    /** \brief Memory maps a binary sequence file written by writeBinary().
+     *  \param filename Path of the file.
+     *  The file stays mapped until the table is cleared, read again or destroyed.
+     */
+    bool readBinary(const std::string &filename);
+
+    /** \brief Writes the table in the binary format read by readBinary().
+     */
+    bool writeBinary(const std::string &filename) const;
+
+    /** \brief Checks whether a binary file can be used instead of the text file it was converted from.
+     *  \param binaryFilename Path of the binary file.
+     *  \param textFilename   Path of the text file, empty if it was not found.
+     *  \return false if the text file has been modified after the binary file was written, or in the same second
+     *          (modification times have a resolution of one second), true otherwise.
+     */
+    static bool isBinaryUpToDate(const std::string &binaryFilename, const std::string &textFilename);
+
+    void clear();
+
+    size_t getNrOfRows() const { return rows; }
+    size_t getNrOfColumns() const { return columns; }
+
+    /** \brief Values of a column, contiguous in memory.
+     */
+    const double* column(size_t col) const { return data + col*rows; }
+
+    double operator()(size_t row, size_t col) const { return data[col*rows + row]; }
+
+    private:
+    size_t              rows;
+    size_t              columns;
+    const double        *data;
+    // Storage of the values when they are not memory mapped
+    std::vector<double> storage;
+    void                *mapping;
+    size_t              mappingSize;
+
+    // Non copyable, as it can own a memory mapping
+    trajectoryTable(const trajectoryTable &);
+    trajectoryTable& operator=(const trajectoryTable &);
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "actionClass.h"
+#include <yarp/os/Time.h>
 
 using namespace std;
 
@@ -15,6 +16,7 @@ actionStruct::actionStruct() {
 
 actionStructForTorqueBalancing::actionStructForTorqueBalancing()
 {
+    current_sample = 0;
 //    for (int i = 0; i < COM_TRAJ_NUM_COLS; i++)
 //        actionStructForTorqueBalancing::com_traj[i] = 0.0;
 //    for (int i = 0; i < POSTURAL_TRAJ_NUM_COLS; i++)
@@ -32,6 +34,61 @@ actionClass::actionClass()
 bool actionClass::openFile(std::string filename, yarp::os::ResourceFinder &rf)
 {
     bool ret = true;
+
+    // Binary sequences are memory mapped instead of being parsed, unless a text file has been modified after the conversion
+    string binary_left  = rf.findFile(filename + "_left" + ".bin");
+    string binary_right = rf.findFile(filename + "_right" + ".bin");
+    string binary_torso = rf.findFile(filename + "_torso" + ".bin");
+    bool use_binary = binary_left != "" && binary_right != "" && binary_torso != "";
+    if (use_binary &&
+        (!trajectoryTable::isBinaryUpToDate(binary_left,  rf.findFile(filename + "_left" + ".txt")) ||
+         !trajectoryTable::isBinaryUpToDate(binary_right, rf.findFile(filename + "_right" + ".txt")) ||
+         !trajectoryTable::isBinaryUpToDate(binary_torso, rf.findFile(filename + "_torso" + ".txt"))))
+    {
+        fprintf(stderr, "[WARNING] The binary files of %s are older than the text files, the text files will be parsed. Run --convertToBinary again to update them\n", filename.c_str());
+        use_binary = false;
+    }
+    if (use_binary)
+    {
+        fprintf(stderr, "||| Binary files found for left leg: %s\n", binary_left.c_str());
+        fprintf(stderr, "||| Binary files found for right leg: %s\n", binary_right.c_str());
+        fprintf(stderr, "||| Binary files found for torso: %s\n", binary_torso.c_str());
+        trajectoryTable left, right, torso;
+        if (!left.readBinary(binary_left) || !right.readBinary(binary_right) || !torso.readBinary(binary_torso))
+        {
+            return false;
+        }
+        // Columns: counter, time and the joints of the part
+        if (left.getNrOfColumns() != 8 || right.getNrOfColumns() != 8 || torso.getNrOfColumns() != 5)
+        {
+            printf ("error parsing binary files, wrong number of columns\n");
+            return false;
+        }
+        size_t nrOfRows = left.getNrOfRows();
+        if (right.getNrOfRows() < nrOfRows) nrOfRows = right.getNrOfRows();
+        if (torso.getNrOfRows() < nrOfRows) nrOfRows = torso.getNrOfRows();
+
+        action_vector.reserve(action_vector.size() + nrOfRows);
+        for (size_t row = 0; row < nrOfRows; row++)
+        {
+            actionStruct tmp_action;
+            tmp_action.counter = static_cast<int> (torso(row, 0));
+            // As for the text files, the time is the one of the last file
+            tmp_action.time = torso(row, 1);
+            for (int i = 0; i < 6; i++)
+            {
+                tmp_action.q_left_leg[i]  = left(row, i + 2);
+                tmp_action.q_right_leg[i] = right(row, i + 2);
+            }
+            for (int i = 0; i < 3; i++)
+            {
+                tmp_action.q_torso[i] = torso(row, i + 2);
+            }
+            action_vector.push_back(tmp_action);
+        }
+        return true;
+    }
+
     FILE* data_file1 = 0;
     FILE* data_file2 = 0;
     FILE* data_file3 = 0;
@@ -84,6 +141,35 @@ bool actionClass::openFile(std::string filename, yarp::os::ResourceFinder &rf)
     return ret;
 }
 
+bool actionClass::convertToBinary(std::string filenamePrefix, std::string filenameSuffix, yarp::os::ResourceFinder &rf)
+{
+    string filename = rf.findFile(filenamePrefix + "_" + filenameSuffix + ".txt");
+    if (filename == "")
+    {
+        fprintf(stderr, "Unable to find %s_%s.txt\n", filenamePrefix.c_str(), filenameSuffix.c_str());
+        return false;
+    }
+    string binary_filename = filename.substr(0, filename.size() - 4) + ".bin";
+
+    trajectoryTable table;
+    if (!table.readText(filename) || !table.writeBinary(binary_filename))
+    {
+        return false;
+    }
+    // A binary file written in the same second of the text file would be considered older than it: write it again
+    if (!trajectoryTable::isBinaryUpToDate(binary_filename, filename))
+    {
+        yarp::os::Time::delay(1.0);
+        if (!table.writeBinary(binary_filename))
+        {
+            return false;
+        }
+    }
+    fprintf(stderr, "||| Converted %s to %s (%d rows, %d columns)\n", filename.c_str(), binary_filename.c_str(),
+            (int)table.getNrOfRows(), (int)table.getNrOfColumns());
+    return true;
+}
+
 bool actionClass::openTorqueBalancingSequence(std::string filenamePrefix,
                                               yarp::os::ResourceFinder &rf,
                                               std::string comTrajSuffix,
@@ -94,6 +180,7 @@ bool actionClass::openTorqueBalancingSequence(std::string filenamePrefix,
                                               std::string formatConstraintsTraj)
 {
     bool ret = false;
+    action_vector_torqueBalancing.current_sample = 0;
     // Retrieve com data
     ret = parseTorqueBalancingSequences(filenamePrefix, comTrajSuffix, COM_ID, formatComTraj, rf);
     // Retrieve postural data
@@ -101,11 +188,11 @@ bool actionClass::openTorqueBalancingSequence(std::string filenamePrefix,
     // Retrieve constraints data
     ret = ret && parseTorqueBalancingSequences(filenamePrefix, constraintsTrajSuffix, CONSTRAINTS_ID, formatConstraintsTraj, rf);
     cout << "All trajectories retrieved correctly" << endl;
-    cout << "Size of com_traj = " << action_vector_torqueBalancing.com_traj.size() << endl;
-    cout << "Size of postural_traj = " << action_vector_torqueBalancing.postural_traj.size() << endl;
-    cout << "Size of constraints = " << action_vector_torqueBalancing.constraints.size() << endl;
-    assert(this->action_vector_torqueBalancing.com_traj.size() == this->action_vector_torqueBalancing.postural_traj.size());
-    assert(this->action_vector_torqueBalancing.com_traj.size() == this->action_vector_torqueBalancing.constraints.size());
+    cout << "Size of com_traj = " << action_vector_torqueBalancing.com_traj.getNrOfRows() << endl;
+    cout << "Size of postural_traj = " << action_vector_torqueBalancing.postural_traj.getNrOfRows() << endl;
+    cout << "Size of constraints = " << action_vector_torqueBalancing.constraints.getNrOfRows() << endl;
+    assert(this->action_vector_torqueBalancing.com_traj.getNrOfRows() == this->action_vector_torqueBalancing.postural_traj.getNrOfRows());
+    assert(this->action_vector_torqueBalancing.com_traj.getNrOfRows() == this->action_vector_torqueBalancing.constraints.getNrOfRows());
     return ret;
 }
 
@@ -115,53 +202,38 @@ bool actionClass::parseTorqueBalancingSequences(std::string              filenam
                                                 std::string              format,
                                                 yarp::os::ResourceFinder &rf)
 {
-    bool ret = false;
-    actionStructForTorqueBalancing tmp_action;
-    string filename  = filenamePrefix + "_" + filenameSuffix + ".txt";
-    filename  = rf.findFile(filename);
-    fprintf(stderr, "[!!!] File found for %s: %s\n", filenameSuffix.c_str(), filename.c_str());
-    // Open file
-    ifstream data_file( filename.c_str() );
-    string line;
-    std::deque<double> tmp_com;
-    std::deque<double> tmp_postural;
-    std::deque<double> tmp_constraints;
-
-    while( std::getline(data_file, line) )
+    trajectoryTable *table = 0;
+    if (partID == COM_ID)
+        table = &action_vector_torqueBalancing.com_traj;
+    if (partID == POSTURAL_ID)
+        table = &action_vector_torqueBalancing.postural_traj;
+    if (partID == CONSTRAINTS_ID)
+        table = &action_vector_torqueBalancing.constraints;
+    if (table == 0)
+        return false;
+
+    // The binary file, when available and not older than the text one, is memory mapped instead of parsing the text one
+    string binary_filename = rf.findFile(filenamePrefix + "_" + filenameSuffix + ".bin");
+    string filename = rf.findFile(filenamePrefix + "_" + filenameSuffix + ".txt");
+    if (binary_filename != "")
     {
-        int col = 0;
-        std::istringstream iss( line );
-        std::string result;
-        tmp_com.clear();
-        tmp_postural.clear();
-        tmp_constraints.clear();
-        while( std::getline( iss, result , ' ') )
+        if (trajectoryTable::isBinaryUpToDate(binary_filename, filename))
         {
-            if ( strcmp(result.c_str(),"") != 0 )
-            {
-                std::stringstream convertor;
-                convertor.clear();
-                convertor.str(result);
-                if (partID == COM_ID)
-                    tmp_com.push_back(atof(result.c_str()));
-                if (partID == POSTURAL_ID)
-                    tmp_postural.push_back(atof(result.c_str()));
-                if (partID == CONSTRAINTS_ID)
-                    tmp_constraints.push_back(atoi(result.c_str()));
-                col++;
-            }
+            fprintf(stderr, "[!!!] Binary file found for %s: %s\n", filenameSuffix.c_str(), binary_filename.c_str());
+            return table->readBinary(binary_filename);
         }
-        if (partID == COM_ID)
-            action_vector_torqueBalancing.com_traj.push_back(tmp_com);
-        if (partID == POSTURAL_ID)
-            action_vector_torqueBalancing.postural_traj.push_back(tmp_postural);
-        if (partID == CONSTRAINTS_ID)
-            action_vector_torqueBalancing.constraints.push_back(tmp_constraints);
+        fprintf(stderr, "[WARNING] %s is older than %s, the text file will be parsed. Run --convertToBinary again to update it\n",
+                binary_filename.c_str(), filename.c_str());
     }
-    
-    data_file.close();
-    ret = true;
-    return ret;
+
+    fprintf(stderr, "[!!!] File found for %s: %s\n", filenameSuffix.c_str(), filename.c_str());
+    if (filename == "")
+    {
+        // Missing trajectories are simply not streamed
+        table->clear();
+        return true;
+    }
+    return table->readText(filename);
 }
 
 bool actionClass::parseCommandLine(char* command_line1, char* command_line2, char* command_line3, int line)
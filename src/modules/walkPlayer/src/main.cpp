@@ -32,6 +32,7 @@
 
 #include "constants.h"
 #include "scriptModule.h"
+#include "actionClass.h"
 
 #include <fstream>
 #include <iostream>
@@ -66,9 +67,30 @@ int main(int argc, char *argv[])
         cout << "\t--refSpeedMinJerk    [0] Reference speed value used by the minimun jerk controllers. " << endl;
         cout << "\t--minJerkLimit       [0] (int) Limit of the trajectory points after which position direct commands are sent " << endl;
         cout <<"\t--torqueBalancingSequence [torqueBalancing] Prefix of the sequences for torque balancing. Overwrites the execute flag value. This option has higher priority and should simply stream trajectories used by the torqueBalancing module." << endl;
+        cout << "\t--convertToBinary    converts the sequences given with --filename and --torqueBalancingSequence to binary files (.bin), loaded instead of the text ones, and exits" << endl;
         return 0;
     }
 
+    if (rf.check("convertToBinary"))
+    {
+        bool ok = true;
+        if (rf.check("filename"))
+        {
+            string filename = rf.find("filename").asString().c_str();
+            ok = actionClass::convertToBinary(filename, "left", rf) && ok;
+            ok = actionClass::convertToBinary(filename, "right", rf) && ok;
+            ok = actionClass::convertToBinary(filename, "torso", rf) && ok;
+        }
+        if (rf.check("torqueBalancingSequence"))
+        {
+            string filenamePrefix = rf.find("torqueBalancingSequence").asString().c_str();
+            ok = actionClass::convertToBinary(filenamePrefix, "comTraj", rf) && ok;
+            ok = actionClass::convertToBinary(filenamePrefix, "posturalTraj", rf) && ok;
+            ok = actionClass::convertToBinary(filenamePrefix, "constraints", rf) && ok;
+        }
+        return ok ? 0 : -1;
+    }
+
     Network yarp;
 
     if (!yarp.checkNetwork())
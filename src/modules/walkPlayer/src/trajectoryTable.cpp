@@ -0,0 +1,242 @@
+#include "trajectoryTable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char     TRAJECTORY_TABLE_MAGIC[8]   = {'W','P','T','R','A','J','\0','\0'};
+static const uint32_t TRAJECTORY_TABLE_VERSION    = 1;
+static const uint32_t TRAJECTORY_TABLE_BYTE_ORDER = 0x01020304;
+
+trajectoryTable::trajectoryTable()
+{
+    rows        = 0;
+    columns     = 0;
+    data        = 0;
+    mapping     = 0;
+    mappingSize = 0;
+}
+
+trajectoryTable::~trajectoryTable()
+{
+    clear();
+}
+
+void trajectoryTable::clear()
+{
+#ifndef _WIN32
+    if (mapping)
+    {
+        munmap(mapping, mappingSize);
+    }
+#endif
+    mapping     = 0;
+    mappingSize = 0;
+    storage.clear();
+    rows    = 0;
+    columns = 0;
+    data    = 0;
+}
+
+bool trajectoryTable::readText(const std::string &filename)
+{
+    clear();
+    ifstream data_file(filename.c_str());
+    if (!data_file.is_open())
+    {
+        fprintf(stderr, "trajectoryTable: unable to open %s\n", filename.c_str());
+        return false;
+    }
+
+    // Values are read by rows and then reordered by columns
+    vector<double> rowValues;
+    string line;
+    int line_number = 0;
+    while (getline(data_file, line))
+    {
+        line_number++;
+        size_t line_columns = 0;
+        const char *p = line.c_str();
+        while (true)
+        {
+            while (*p == ' ' || *p == '\t' || *p == ',' || *p == '\r')
+            {
+                p++;
+            }
+            if (*p == '\0')
+            {
+                break;
+            }
+            char *end = 0;
+            double value = strtod(p, &end);
+            if (end == p)
+            {
+                fprintf(stderr, "trajectoryTable: invalid value in %s, line %d\n", filename.c_str(), line_number);
+                clear();
+                return false;
+            }
+            rowValues.push_back(value);
+            line_columns++;
+            p = end;
+        }
+
+        if (line_columns == 0)
+        {
+            continue;
+        }
+        if (rows == 0)
+        {
+            columns = line_columns;
+        }
+        else if (line_columns != columns)
+        {
+            fprintf(stderr, "trajectoryTable: line %d of %s has %d values instead of %d\n",
+                    line_number, filename.c_str(), (int)line_columns, (int)columns);
+            clear();
+            return false;
+        }
+        rows++;
+    }
+
+    storage.resize(rowValues.size());
+    for (size_t row = 0; row < rows; row++)
+    {
+        for (size_t col = 0; col < columns; col++)
+        {
+            storage[col*rows + row] = rowValues[row*columns + col];
+        }
+    }
+    data = storage.empty() ? 0 : &storage[0];
+    return true;
+}
+
+bool trajectoryTable::readBinary(const std::string &filename)
+{
+    clear();
+    FILE *data_file = fopen(filename.c_str(), "rb");
+    if (data_file == NULL)
+    {
+        fprintf(stderr, "trajectoryTable: unable to open %s\n", filename.c_str());
+        return false;
+    }
+
+    trajectoryTableHeader header;
+    bool ok = fread(&header, sizeof(header), 1, data_file) == 1 &&
+              memcmp(header.magic, TRAJECTORY_TABLE_MAGIC, sizeof(header.magic)) == 0;
+    if (!ok)
+    {
+        fprintf(stderr, "trajectoryTable: %s is not a binary trajectory file\n", filename.c_str());
+        fclose(data_file);
+        return false;
+    }
+    if (header.version != TRAJECTORY_TABLE_VERSION || header.byteOrder != TRAJECTORY_TABLE_BYTE_ORDER)
+    {
+        fprintf(stderr, "trajectoryTable: %s has an unsupported version or byte order, convert it again from the text file\n", filename.c_str());
+        fclose(data_file);
+        return false;
+    }
+
+    size_t nrOfValues = static_cast<size_t>(header.nrOfRows*header.nrOfColumns);
+    size_t fileSize = sizeof(header) + nrOfValues*sizeof(double);
+
+#ifndef _WIN32
+    fclose(data_file);
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat file_status;
+    if (fd < 0 || fstat(fd, &file_status) != 0 || static_cast<size_t>(file_status.st_size) != fileSize)
+    {
+        fprintf(stderr, "trajectoryTable: %s is truncated or unreadable\n", filename.c_str());
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+    void *mapped = mmap(0, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the file is closed
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        fprintf(stderr, "trajectoryTable: unable to map %s\n", filename.c_str());
+        return false;
+    }
+    mapping     = mapped;
+    mappingSize = fileSize;
+    data        = reinterpret_cast<const double*>(static_cast<const char*>(mapped) + sizeof(header));
+#else
+    storage.resize(nrOfValues);
+    if (nrOfValues > 0 && fread(&storage[0], sizeof(double), nrOfValues, data_file) != nrOfValues)
+    {
+        fprintf(stderr, "trajectoryTable: %s is truncated\n", filename.c_str());
+        fclose(data_file);
+        storage.clear();
+        return false;
+    }
+    fclose(data_file);
+    data = storage.empty() ? 0 : &storage[0];
+#endif
+
+    rows    = static_cast<size_t>(header.nrOfRows);
+    columns = static_cast<size_t>(header.nrOfColumns);
+    return true;
+}
+
+bool trajectoryTable::writeBinary(const std::string &filename) const
+{
+    FILE *data_file = fopen(filename.c_str(), "wb");
+    if (data_file == NULL)
+    {
+        fprintf(stderr, "trajectoryTable: unable to create %s\n", filename.c_str());
+        return false;
+    }
+
+    trajectoryTableHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRAJECTORY_TABLE_MAGIC, sizeof(header.magic));
+    header.version     = TRAJECTORY_TABLE_VERSION;
+    header.byteOrder   = TRAJECTORY_TABLE_BYTE_ORDER;
+    header.nrOfRows    = rows;
+    header.nrOfColumns = columns;
+
+    size_t nrOfValues = rows*columns;
+    bool ok = fwrite(&header, sizeof(header), 1, data_file) == 1;
+    ok = ok && (nrOfValues == 0 || fwrite(data, sizeof(double), nrOfValues, data_file) == nrOfValues);
+    ok = (fclose(data_file) == 0) && ok;
+    if (!ok)
+    {
+        fprintf(stderr, "trajectoryTable: error writing %s\n", filename.c_str());
+    }
+    return ok;
+}
+
+bool trajectoryTable::isBinaryUpToDate(const std::string &binaryFilename, const std::string &textFilename)
+{
+    if (textFilename == "")
+    {
+        return true;
+    }
+    struct stat binary_status;
+    struct stat text_status;
+    if (stat(textFilename.c_str(), &text_status) != 0)
+    {
+        return true;
+    }
+    if (stat(binaryFilename.c_str(), &binary_status) != 0)
+    {
+        return false;
+    }
+    // Modification times have a resolution of one second: a binary file written in the same second
+    // of the text file could have been converted from a previous version of it
+    return binary_status.st_mtime > text_status.st_mtime;
+}
@@ -229,41 +229,27 @@ void WorkingThread::compute_and_send_command(int j)
     bot_postural.clear();
     bot_constraints.clear();
     
-    if ( !actions.action_vector_torqueBalancing.com_traj.empty() )
+    actionStructForTorqueBalancing &torqueBalancing = actions.action_vector_torqueBalancing;
+    size_t sample = torqueBalancing.current_sample;
+    
+    if ( sample < torqueBalancing.com_traj.getNrOfRows() )
     {
-        std::deque<double> tmpCom_i = actions.action_vector_torqueBalancing.com_traj.front();
-        while ( !tmpCom_i.empty() )
-        {
-            bot_com.addDouble( tmpCom_i.front() );
-            tmpCom_i.pop_front();
-        }
-        actions.action_vector_torqueBalancing.com_traj.pop_front();
-        tmpCom_i.clear();
+        for (size_t col = 0; col < torqueBalancing.com_traj.getNrOfColumns(); col++)
+            bot_com.addDouble( torqueBalancing.com_traj(sample, col) );
     }
     
-    if ( !actions.action_vector_torqueBalancing.postural_traj.empty() )
+    if ( sample < torqueBalancing.postural_traj.getNrOfRows() )
     {
-        std::deque<double> tmpPostural_i = actions.action_vector_torqueBalancing.postural_traj.front();
-        while ( !tmpPostural_i.empty() )
-        {
-            bot_postural.addDouble( tmpPostural_i.front() );
-            tmpPostural_i.pop_front();
-        }
-        actions.action_vector_torqueBalancing.postural_traj.pop_front();
-        tmpPostural_i.clear();
+        for (size_t col = 0; col < torqueBalancing.postural_traj.getNrOfColumns(); col++)
+            bot_postural.addDouble( torqueBalancing.postural_traj(sample, col) );
     }
     
-    if ( !actions.action_vector_torqueBalancing.constraints.empty() )
+    if ( sample < torqueBalancing.constraints.getNrOfRows() )
     {
-        std::deque<double> tmpConstraints_i = actions.action_vector_torqueBalancing.constraints.front();
-        while ( !tmpConstraints_i.empty() )
-        {
-            bot_constraints.addDouble( tmpConstraints_i.front() );
-            tmpConstraints_i.pop_front();
-        }
-        actions.action_vector_torqueBalancing.constraints.pop_front();
-        tmpConstraints_i.clear();
+        for (size_t col = 0; col < torqueBalancing.constraints.getNrOfColumns(); col++)
+            bot_constraints.addDouble( torqueBalancing.constraints(sample, col) );
     }
+    torqueBalancing.current_sample++;
     
     this->port_command_com.setEnvelope(this->timestamp);
     this->port_command_com.write();
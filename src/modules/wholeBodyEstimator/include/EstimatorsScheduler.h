@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2015 Fondazione Istituto Italiano di Tecnologia - Italian Institute of Technology
+ * Author: Jorhabib Eljaik
+ * email:  jorhabib.eljaik@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+#ifndef ESTIMATORSSCHEDULER_H_
+#define ESTIMATORSSCHEDULER_H_
+
+#include <yarp/os/Thread.h>
+#include <yarp/os/Semaphore.h>
+#include <yarp/os/Mutex.h>
+#include <yarp/os/ResourceFinder.h>
+
+#include <string>
+#include <vector>
+
+#include "IEstimator.h"
+
+/**
+ *  Runs the estimators of WholeBodyEstimatorThread, one cycle for each call of run().
+ *
+ *  The estimators are grouped in stages according to the inputs and outputs they declare
+ *  (see IEstimator::getInputs and IEstimator::getOutputs): an estimator is placed in the stage
+ *  following the ones of all the estimators producing its inputs. The estimators of a stage are
+ *  run concurrently by a pool of worker threads and by the thread calling run(), and a stage
+ *  starts only when the previous one is completed.
+ *  Each estimator can be run every decimation calls of run() (i.e. every decimation periods of
+ *  WholeBodyEstimatorThread), in the calls whose index modulo decimation equals its phase, so that
+ *  the slow estimators can be spread over different cycles. The estimators run in a cycle depend
+ *  only on the cycle index, and the ones that are not run in a cycle are simply skipped.
+ *  The time spent in run() by each estimator is recorded.
+ */
+class EstimatorsScheduler
+{
+public:
+    /**
+     *  Statistics of the time spent by an estimator in IEstimator::run(), in seconds.
+     */
+    struct EstimatorTiming
+    {
+        double last;
+        double max;
+        double sum;
+        unsigned long count;
+    };
+
+private:
+    /**
+     *  Worker thread of the pool. It waits to be started by the scheduler, runs the estimators
+     *  of the current stage that are not taken by the other threads and notifies the scheduler.
+     */
+    class Worker : public yarp::os::Thread
+    {
+    private:
+        EstimatorsScheduler & m_scheduler;
+        yarp::os::Semaphore   m_startSemaphore;
+
+    public:
+        Worker(EstimatorsScheduler & scheduler);
+        void wakeUp();
+        void run();
+        void onStop();
+    };
+
+    std::vector<IEstimator*>          m_estimators;
+    std::vector<std::string>          m_names;
+    std::vector< std::vector<int> >   m_stages;
+    std::vector<EstimatorTiming>      m_timings;
+    std::vector<int>                  m_decimations;
+    std::vector<int>                  m_phases;
+    unsigned long                     m_cycle;
+
+    std::vector<Worker*>              m_workers;
+    yarp::os::Semaphore               m_doneSemaphore;
+    yarp::os::Mutex                   m_jobsMutex;
+    std::vector<int>                  m_currentJobs;
+    int                               m_nextJob;
+
+    bool computeStages();
+    void runStageJobs();
+    void runEstimator(int estimator);
+
+public:
+    EstimatorsScheduler();
+    ~EstimatorsScheduler();
+
+    /**
+     *  Computes the stages and starts the worker threads.
+     *
+     *  @param estimators  Estimators to be run. They must have been initialized, as their inputs and outputs are queried here.
+     *  @param names       Names of the estimators, used for the messages and the timing statistics.
+     *  @param nrOfWorkers Number of worker threads. If negative, the size of the largest stage minus one is used
+     *                     (the thread calling run() runs estimators as well). With 0 the estimators are run sequentially.
+     *
+     *  @return false if the dependencies between the estimators are not valid (e.g. they are cyclic) or a worker could not be started.
+     */
+    bool configure(const std::vector<IEstimator*> & estimators,
+                   const std::vector<std::string> & names,
+                   int nrOfWorkers);
+
+    /**
+     *  Sets how often an estimator is run. By default every estimator is run at each call of run().
+     *
+     *  @param estimator  Index of the estimator, in the order passed to configure().
+     *  @param decimation The estimator is run once every decimation calls of run().
+     *  @param phase      Call, between 0 and decimation-1, in which the estimator is run.
+     *
+     *  @return false if the parameters are not valid.
+     */
+    bool setDecimation(int estimator, int decimation, int phase);
+
+    /**
+     *  Reads the rate of an estimator from the group with its name, through one of the parameters:
+     *  - rate:       frequency in Hz, rounded to the nearest integer divisor of the thread frequency;
+     *  - decimation: number of thread periods between two runs of the estimator;
+     *  and the optional parameter phase, that is the thread period in which the estimator is run (by default defaultPhase).
+     *
+     *  @param rf           Module resource finder.
+     *  @param name         Name of the estimator.
+     *  @param threadPeriod Period of WholeBodyEstimatorThread in milliseconds.
+     *  @param decimation   Decimation of the estimator, 1 if neither rate nor decimation are specified (output).
+     *  @param phase        Phase of the estimator (output).
+     *  @param defaultPhase Phase used if phase is not specified, wrapped to decimation.
+     *
+     *  @return false if the parameters are not valid.
+     */
+    static bool readEstimatorRate(yarp::os::ResourceFinder & rf,
+                                  const std::string & name,
+                                  int threadPeriod,
+                                  int & decimation,
+                                  int & phase,
+                                  int defaultPhase = 0);
+
+    /**
+     *  Runs once, in dependency order, every estimator scheduled in the current cycle.
+     */
+    void run();
+
+    /**
+     *  Stops the worker threads. It does not release the estimators.
+     */
+    void close();
+
+    int getNrOfWorkers() const { return static_cast<int>(m_workers.size()); }
+
+    const std::vector<EstimatorTiming> & getTimingStatistics() const { return m_timings; }
+
+    /**
+     *  Human readable timing statistics of the estimators, one line for each of them.
+     */
+    std::string getTimingStatisticsString() const;
+
+    /**
+     *  Resets the timing statistics of the estimators.
+     */
+    void resetTimingStatistics();
+};
+
+#endif
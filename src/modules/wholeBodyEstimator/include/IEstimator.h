@@ -19,6 +19,8 @@
 #define IESTIMATOR_H_
 
 #include <yarp/os/ResourceFinder.h>
+#include <string>
+#include <vector>
 #include <yarpWholeBodyInterface/yarpWholeBodyInterface.h>
 // We need to include the factory here so that the derived classes of IEstimator can use the macros defined there.
 #include "EstimatorsFactory.h"
@@ -48,6 +50,20 @@ public:
      *  Releases allocated resources and closes opened ports during initialization.
      */
     virtual void release() = 0;
+    /**
+     *  Names of the quantities produced by other estimators that this estimator reads in run() (e.g. "floatingBaseState").
+     *  The estimators are run concurrently by WholeBodyEstimatorThread, unless one of them reads a quantity produced
+     *  by the other: in this case the producer is run first. The default implementation declares no inputs.
+     *
+     *  - parameter inputs: Names of the quantities read (output).
+     */
+    virtual void getInputs(std::vector<std::string> &inputs) const;
+    /**
+     *  Names of the quantities produced by this estimator in run(). The default implementation declares no outputs.
+     *
+     *  - parameter outputs: Names of the quantities produced (output).
+     */
+    virtual void getOutputs(std::vector<std::string> &outputs) const;
 };
 
 #endif
@@ -19,6 +19,7 @@
 
 
 #include "IEstimator.h"
+#include "LeggedOdometryFrames.h"
 #include <yarp/os/BufferedPort.h>
 #include <yarp/os/ResourceFinder.h>
 #include <yarp/os/Contactable.h>
@@ -48,7 +49,7 @@ private:
     bool odometry_enabled;
     bool frames_streaming_enabled;
     yarp::os::BufferedPort<yarp::os::Bottle> * port_floatingbasestate;
-    yarp::os::BufferedPort<yarp::os::Property> * port_frames;
+    yarp::os::BufferedPort<LeggedOdometryFrames> * port_frames;
     /**
      *  Vector containing the indices of the frames to be streamed, after checking they are actually present. These frame have been specified via configuration file of the wholeBodyEstimator under the group LeggedOdometry.
      */
@@ -57,8 +58,10 @@ private:
      *  Vector containing the names of the frames to be streamed, after checking they are actually present.
      */
     std::vector<std::string> frames_to_stream;
-    std::vector<yarp::os::Bottle> buffer_bottles;
-    yarp::sig::Matrix buffer_transform_matrix;
+    /**
+     *  Sequence number of the next message streamed on port_frames.
+     */
+    int frames_sequence_number;
     bool com_streaming_enabled;
     yarp::os::BufferedPort<yarp::sig::Vector> * port_com;
     std::string current_fixed_link_name;
@@ -94,6 +97,11 @@ public:
      */
     void release();
 
+    /**
+     *  LeggedOdometry produces the floating base state ("floatingBaseState"), published on /LeggedOdometry/floatingbasestate:o.
+     */
+    void getOutputs(std::vector<std::string> &outputs) const;
+
     /**
      *  Closes a single port properly.
      */
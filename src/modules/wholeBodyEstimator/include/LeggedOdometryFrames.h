@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2015 Fondazione Istituto Italiano di Tecnologia - Italian Institute of Technology
+ * Author: Jorhabib Eljaik
+ * email:  jorhabib.eljaik@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+#ifndef LEGGEDODOMETRYFRAMES_H_
+#define LEGGEDODOMETRYFRAMES_H_
+
+#include <yarp/os/Portable.h>
+#include <yarp/os/ConnectionReader.h>
+#include <yarp/os/ConnectionWriter.h>
+
+#include <vector>
+
+/**
+ *  World poses of the frames streamed by LeggedOdometry on /LeggedOdometry/frames:o.
+ *
+ *  The poses are stored contiguously as 4x4 homogeneous transforms world_H_frame, serialized row-wise,
+ *  in the same order of the additional_frames parameter of LeggedOdometry.
+ *  On the wire the message is compatible with a Bottle containing
+ *  (sequenceNumber timestamp nrOfFrames (transforms...)), where the transforms are sent as a single
+ *  block of doubles, so it can also be read with a Bottle (e.g. with yarp read).
+ */
+class LeggedOdometryFrames : public yarp::os::Portable
+{
+private:
+    int                 m_sequenceNumber;
+    double              m_timestamp;
+    std::vector<double> m_transforms;
+
+public:
+    static const int TRANSFORM_SIZE = 16;
+
+    LeggedOdometryFrames();
+
+    /**
+     *  Sets the number of frames. The storage is reallocated only if the number of frames grows.
+     */
+    void resize(int nrOfFrames);
+
+    int getNrOfFrames() const { return static_cast<int>(m_transforms.size())/TRANSFORM_SIZE; }
+
+    int getSequenceNumber() const { return m_sequenceNumber; }
+    void setSequenceNumber(int sequenceNumber) { m_sequenceNumber = sequenceNumber; }
+
+    /**
+     *  Time, in seconds, at which the poses were computed.
+     */
+    double getTimestamp() const { return m_timestamp; }
+    void setTimestamp(double timestamp) { m_timestamp = timestamp; }
+
+    /**
+     *  Homogeneous transform world_H_frame of a frame (16 elements, row-wise).
+     */
+    double * transform(int frame) { return &m_transforms[TRANSFORM_SIZE*frame]; }
+    const double * transform(int frame) const { return &m_transforms[TRANSFORM_SIZE*frame]; }
+
+    virtual bool read(yarp::os::ConnectionReader & connection);
+    virtual bool write(yarp::os::ConnectionWriter & connection);
+};
+
+#endif
@@ -26,6 +26,7 @@
 #include "nonLinearAnalyticConditionalGaussian.h"
 #include "nonLinearMeasurementGaussianPdf.h"
 #include "floatingBase.h"
+#include "quaternionEKFEigenFilter.h"
 
 #include <yarp/os/ResourceFinder.h>
 #include <yarp/os/BufferedPort.h>
@@ -101,6 +102,21 @@ struct quaternionEKFParams
      *  Enables the floating base attitude estimate
      */
     bool floatingBaseAttitude;
+    /**
+     *  Use the Eigen implementation of the filter (quaternionEKFEigenFilter) instead of BFL::ExtendedKalmanFilter.
+     *  Set with the parameter filter_backend (bfl or eigen, default bfl).
+     */
+    bool useEigenFilter;
+    /**
+     *  Robot parts (e.g. right_leg) of the MTB boards tracked in batch, as listed in the parameter mtb_boards.
+     *  When mtb_boards is specified, all these boards are estimated with the Eigen implementation of the filter,
+     *  and the first one is used for the single board outputs (Euler angles, floating base attitude).
+     */
+    std::vector<std::string> mtbBoardsParts;
+    /**
+     *  IDs of the MTB boards tracked in batch, as listed in the parameter mtb_boards.
+     */
+    std::vector<int> mtbBoardsIDs;
     /**
      *  Rotation matrix from FT sensor to accelerometer. This is temporary while added to the URDF of the robot
      */
@@ -112,7 +128,8 @@ enum outputPorts {
     ORIENTATION_ESTIMATE_PORT_EULER,
     RAW_ACCELEROMETER_DATA_PORT,
     RAW_GYROSCOPE_DATA_PORT,
-    FLOATING_BASE_ROTATION_PORT
+    FLOATING_BASE_ROTATION_PORT,
+    ORIENTATION_ESTIMATE_PORT_QUATERNION_BATCH
 };
 
 /**
@@ -232,6 +249,9 @@ class QuaternionEKF : public IEstimator
     // Every estimator must register itself first here this way
     REGISTER(QuaternionEKF)
 public:
+    // m_eigenFilter contains fixed-size vectorizable Eigen matrices
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
     QuaternionEKF();
     virtual ~QuaternionEKF();
     /**
@@ -258,6 +278,15 @@ public:
      */
     void run();
     void release();
+    /**
+     *  When floating_base_attitude is enabled the floating base attitude is computed from the robot joints read through
+     *  the whole body sensors, as done by LeggedOdometry: QuaternionEKF then reads "floatingBaseState" and is run after it.
+     */
+    void getInputs(std::vector<std::string> &inputs) const;
+    /**
+     *  QuaternionEKF produces the orientation of the MTB boards ("mtbOrientation").
+     */
+    void getOutputs(std::vector<std::string> &outputs) const;
     //TODO: This method should also be enforced through IEstimator
     /**
      *  Reads the filter parameters specified under the group CLASSNAME.
@@ -286,6 +315,11 @@ public:
      *  Instantiates an Extended Kalman Filter of type BFL::ExtendedKalmanFilter.
      */
     void createFilter();
+    /**
+     *  Updates the system noise covariance and performs the prediction and update steps of the BFL::ExtendedKalmanFilter,
+        copying the posterior mean in m_posterior_state.
+     */
+    void updateBFLFilter();
     //FIXME: This should not exist at all. yarpWholeBodySensors should be able to read this after proper initialization.
     /**
      *  Temporary fix while yarpWholeBodySensors parses acceleromenters and gyros from URDF and provides this measurement directly through the interface.
@@ -307,6 +341,20 @@ public:
      *  @return True when
      */
     bool extractMTBDatafromPort(int boardNum, measurementsStruct &measurements);
+    /**
+     *  Reads the ports of all the robot parts with boards listed in mtb_boards, and fills the measurements
+        of m_batchFilter with the converted linear accelerations and angular velocities.
+     *
+     *  @return True if all the ports were read, false otherwise.
+     */
+    bool readBatchSensorData();
+    /**
+     *  Parses the measurement as streamed by the inertial units of one robot part (read in m_batchRawMeasurement),
+        copying the data of the boards of that part in the measurements of m_batchFilter.
+     *
+     *  @param partIndex Index of the part in m_batchParts.
+     */
+    void extractMTBBatchData(int partIndex);
     //TODO: Temporary
     void XiOperator(MatrixWrapper::ColumnVector quat, MatrixWrapper::Matrix* Xi);
     void SOperator(MatrixWrapper::ColumnVector omg, MatrixWrapper::Matrix* S);
@@ -325,6 +373,15 @@ private:
     BFL::AnalyticMeasurementModelGaussianUncertainty * m_meas_model;
     BFL::Gaussian * m_prior;
     BFL::ExtendedKalmanFilter * m_filter;
+    // Alternative implementation of the filter, used when m_quaternionEKFParams.useEigenFilter is true
+    wholeBodyEstimator::quaternionEKFEigenFilter m_eigenFilter;
+    // Batch estimation of the boards listed in mtb_boards
+    bool m_batchEstimation;
+    wholeBodyEstimator::quaternionEKFEigenFilterBatch m_batchFilter;
+    std::vector<std::string> m_batchParts;               // Distinct robot parts of the boards
+    std::vector<yarp::os::Port *> m_batchSensorPorts;    // One reader port for each part
+    std::vector<int> m_batchBoardsPart;                  // Index in m_batchParts of each board
+    yarp::sig::Vector m_batchRawMeasurement;
     MatrixWrapper::ColumnVector m_prior_mu_vec;
     MatrixWrapper::ColumnVector m_posterior_state;
     //FIXME This should be temporary
@@ -36,6 +36,7 @@
 #include <map>              //std::map
 
 #include "EstimatorsFactory.h"
+#include "EstimatorsScheduler.h"
 #include "IEstimator.h"
 #include "LeggedOdometry.h"
 #include "QuaternionEKF.h"
@@ -56,6 +57,12 @@ private:
     
     std::map< std::string, int > m_estimatorsMap;
     std::vector< IEstimator* > m_estimatorsList;
+    std::vector< std::string > m_estimatorsNames;
+
+    // Runs the estimators concurrently when their declared inputs and outputs allow it
+    EstimatorsScheduler m_scheduler;
+    bool m_verbose;
+    double m_lastTimingPrintTime;
 
 public:
     WholeBodyEstimatorThread (yarp::os::ResourceFinder &rf, wbi::iWholeBodySensors* wbs, int period);
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2015 Fondazione Istituto Italiano di Tecnologia - Italian Institute of Technology
+ * Author: Jorhabib Eljaik
+ * email:  jorhabib.eljaik@iit.it
+ * Permission is granted to copy, distribute, and/or modify this program
+ * under the terms of the GNU General Public License, version 2 or any
+ * later version published by the Free Software Foundation.
+ *
+ * A copy of the license can be found at
+ * http://www.robotcub.org/icub/license/gpl.txt
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details
+ */
+
+#ifndef QUATERNION_EKF_EIGEN_FILTER_H_
+#define QUATERNION_EKF_EIGEN_FILTER_H_
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+#include <Eigen/StdVector>
+#include <vector>
+
+namespace wholeBodyEstimator
+{
+    /**
+     *  Extended Kalman Filter for the attitude quaternion, implementing the same system and measurement models
+     *  of BFL::nonLinearAnalyticConditionalGaussian and BFL::nonLinearMeasurementGaussianPdf (and the same
+     *  prediction and update steps of BFL::ExtendedKalmanFilter) with fixed-size Eigen matrices.
+     *  No memory is allocated after construction, therefore it can be used in place of the BFL filter
+     *  when QuaternionEKF has to run at the IMU rate.
+     */
+    class quaternionEKFEigenFilter
+    {
+    public:
+        typedef Eigen::Matrix<double, 4, 1> Vector4;
+        typedef Eigen::Matrix<double, 3, 1> Vector3;
+        typedef Eigen::Matrix<double, 4, 4> Matrix4x4;
+        typedef Eigen::Matrix<double, 4, 3> Matrix4x3;
+        typedef Eigen::Matrix<double, 3, 4> Matrix3x4;
+        typedef Eigen::Matrix<double, 3, 3> Matrix3x3;
+
+    private:
+        double      m_period;
+        double      m_sigmaGyro;
+        double      m_sigmaMeasurementNoise;
+        double      m_priorCovariance;
+        double      m_gravity;
+
+        // Posterior mean and covariance
+        Vector4     m_state;
+        Matrix4x4   m_covariance;
+
+        // Buffers
+        Matrix4x3   m_Xi;
+        Matrix4x4   m_systemNoiseCovariance;
+        Matrix4x4   m_transitionMatrix;
+        Vector4     m_predictedState;
+        Vector3     m_predictedMeasurement;
+        Matrix3x4   m_measurementJacobian;
+        Matrix4x3   m_PHt;
+        Matrix3x3   m_innovationCovariance;
+        Matrix4x3   m_gain;
+        Vector3     m_innovation;
+        Matrix4x4   m_tmpCovariance;
+
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        quaternionEKFEigenFilter();
+
+        /**
+         *  Sets the filter parameters and the priors.
+         *
+         *  @param periodInSeconds       Filter period in seconds.
+         *  @param sigmaGyro             Variance of the gyroscope noise.
+         *  @param sigmaMeasurementNoise Variance of the accelerometer noise.
+         *  @param priorCovariance       Diagonal value of the prior covariance.
+         *  @param gravity               Norm of the gravity used in the measurement model.
+         */
+        void configure(double periodInSeconds,
+                       double sigmaGyro,
+                       double sigmaMeasurementNoise,
+                       double priorCovariance,
+                       double gravity);
+
+        /**
+         *  Sets the state to the prior (identity quaternion) and the covariance to the prior covariance.
+         */
+        void setPriors();
+
+        /**
+         *  Performs the prediction step with the angular velocity and the update step with the linear acceleration.
+         *
+         *  @param angVel Angular velocity in rad/s (3 elements).
+         *  @param linAcc Linear acceleration in m/s^2 (3 elements).
+         *
+         *  @return false if the innovation covariance is not invertible (the state is only predicted), true otherwise.
+         */
+        bool update(const double * angVel, const double * linAcc);
+
+        /**
+         *  Posterior mean (quaternion, real part first).
+         */
+        const Vector4 & getState() const { return m_state; }
+
+        /**
+         *  Posterior covariance.
+         */
+        const Matrix4x4 & getCovariance() const { return m_covariance; }
+    };
+
+    /**
+     *  Batch of quaternionEKFEigenFilter, one for each inertial sensor (e.g. MTB board) tracked by the same estimator.
+     *  All the filters are updated by a single call of update(), that runs each filter in turn:
+     *  the filters are independent and the update is not vectorized across the sensors.
+     */
+    class quaternionEKFEigenFilterBatch
+    {
+    public:
+        typedef Eigen::Matrix<double, 3, Eigen::Dynamic> Matrix3xN;
+        typedef Eigen::Matrix<double, 4, Eigen::Dynamic> Matrix4xN;
+
+    private:
+        std::vector<quaternionEKFEigenFilter, Eigen::aligned_allocator<quaternionEKFEigenFilter> > m_filters;
+        Matrix3xN   m_angularVelocities;
+        Matrix3xN   m_linearAccelerations;
+        Matrix4xN   m_states;
+
+    public:
+        /**
+         *  Allocates the filters and sets their parameters and priors. See quaternionEKFEigenFilter::configure.
+         *
+         *  @param nrOfFilters Number of inertial sensors tracked.
+         */
+        void configure(int nrOfFilters,
+                       double periodInSeconds,
+                       double sigmaGyro,
+                       double sigmaMeasurementNoise,
+                       double priorCovariance,
+                       double gravity);
+
+        int getNrOfFilters() const { return static_cast<int>(m_filters.size()); }
+
+        /**
+         *  Angular velocities (rad/s) of the sensors, one for each column, to be filled before calling update().
+         */
+        Matrix3xN & angularVelocities() { return m_angularVelocities; }
+
+        /**
+         *  Linear accelerations (m/s^2) of the sensors, one for each column, to be filled before calling update().
+         */
+        Matrix3xN & linearAccelerations() { return m_linearAccelerations; }
+
+        /**
+         *  Performs the prediction and update steps of all the filters.
+         *
+         *  @return the number of filters whose update step could not be performed.
+         */
+        int update();
+
+        /**
+         *  Posterior means (quaternions, real part first), one for each column.
+         */
+        const Matrix4xN & getStates() const { return m_states; }
+    };
+}
+
+#endif
@@ -0,0 +1,410 @@
+#include "EstimatorsScheduler.h"
+
+#include <yarp/os/Time.h>
+#include <yarp/os/LogStream.h>
+
+#include <yarp/os/Bottle.h>
+
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <iomanip>
+
+EstimatorsScheduler::Worker::Worker(EstimatorsScheduler & scheduler) : m_scheduler(scheduler),
+                                                                       m_startSemaphore(0)
+{
+}
+
+void EstimatorsScheduler::Worker::wakeUp()
+{
+    m_startSemaphore.post();
+}
+
+void EstimatorsScheduler::Worker::run()
+{
+    while (true)
+    {
+        m_startSemaphore.wait();
+        if (isStopping())
+        {
+            return;
+        }
+        m_scheduler.runStageJobs();
+        m_scheduler.m_doneSemaphore.post();
+    }
+}
+
+void EstimatorsScheduler::Worker::onStop()
+{
+    // Wakes the worker up, so that it can check isStopping()
+    m_startSemaphore.post();
+}
+
+EstimatorsScheduler::EstimatorsScheduler() : m_cycle(0),
+                                             m_doneSemaphore(0),
+                                             m_nextJob(0)
+{
+}
+
+EstimatorsScheduler::~EstimatorsScheduler()
+{
+    close();
+}
+
+bool EstimatorsScheduler::configure(const std::vector<IEstimator*> & estimators,
+                                    const std::vector<std::string> & names,
+                                    int nrOfWorkers)
+{
+    if (estimators.size() != names.size())
+    {
+        yError("[EstimatorsScheduler::configure] %d estimators but %d names were given", (int)estimators.size(), (int)names.size());
+        return false;
+    }
+
+    close();
+    m_estimators = estimators;
+    m_names = names;
+
+    EstimatorTiming zeroTiming = {0.0, 0.0, 0.0, 0};
+    m_timings.assign(m_estimators.size(), zeroTiming);
+    m_decimations.assign(m_estimators.size(), 1);
+    m_phases.assign(m_estimators.size(), 0);
+    m_cycle = 0;
+
+    if ( !computeStages() )
+    {
+        return false;
+    }
+
+    size_t largestStageSize = 0;
+    for (size_t s = 0; s < m_stages.size(); s++)
+    {
+        std::stringstream stageContents;
+        for (size_t j = 0; j < m_stages[s].size(); j++)
+        {
+            stageContents << " " << m_names[m_stages[s][j]];
+        }
+        yInfo("[EstimatorsScheduler::configure] Stage %d:%s", (int)s, stageContents.str().c_str());
+        if (m_stages[s].size() > largestStageSize)
+        {
+            largestStageSize = m_stages[s].size();
+        }
+    }
+    // No allocation while running
+    m_currentJobs.reserve(largestStageSize);
+
+    if (nrOfWorkers < 0)
+    {
+        nrOfWorkers = largestStageSize > 0 ? static_cast<int>(largestStageSize) - 1 : 0;
+    }
+
+    for (int i = 0; i < nrOfWorkers; i++)
+    {
+        Worker * worker = new Worker(*this);
+        if ( !worker->start() )
+        {
+            yError("[EstimatorsScheduler::configure] Could not start worker thread %d", i);
+            delete worker;
+            close();
+            return false;
+        }
+        m_workers.push_back(worker);
+    }
+    yInfo("[EstimatorsScheduler::configure] Running %d estimators in %d stages with %d worker threads",
+          (int)m_estimators.size(), (int)m_stages.size(), nrOfWorkers);
+
+    return true;
+}
+
+bool EstimatorsScheduler::computeStages()
+{
+    const int nrOfEstimators = static_cast<int>(m_estimators.size());
+
+    // Map each output to the estimator producing it
+    std::map<std::string, int> producers;
+    std::vector<std::string> quantities;
+    for (int i = 0; i < nrOfEstimators; i++)
+    {
+        m_estimators[i]->getOutputs(quantities);
+        for (size_t q = 0; q < quantities.size(); q++)
+        {
+            std::map<std::string, int>::iterator producer = producers.find(quantities[q]);
+            if (producer != producers.end())
+            {
+                yError("[EstimatorsScheduler::computeStages] %s is produced by both %s and %s",
+                       quantities[q].c_str(), m_names[producer->second].c_str(), m_names[i].c_str());
+                return false;
+            }
+            producers[quantities[q]] = i;
+        }
+    }
+
+    // Estimators whose outputs are read by each estimator
+    std::vector< std::vector<int> > dependencies(nrOfEstimators);
+    for (int i = 0; i < nrOfEstimators; i++)
+    {
+        m_estimators[i]->getInputs(quantities);
+        for (size_t q = 0; q < quantities.size(); q++)
+        {
+            std::map<std::string, int>::iterator producer = producers.find(quantities[q]);
+            if (producer == producers.end())
+            {
+                yWarning("[EstimatorsScheduler::computeStages] %s reads %s, that is not produced by any estimator",
+                         m_names[i].c_str(), quantities[q].c_str());
+                continue;
+            }
+            if (producer->second == i)
+            {
+                continue;
+            }
+            dependencies[i].push_back(producer->second);
+        }
+    }
+
+    // An estimator goes in the first stage following the ones of its dependencies
+    std::vector<int> stageOf(nrOfEstimators, -1);
+    int nrOfAssigned = 0;
+    m_stages.clear();
+    while (nrOfAssigned < nrOfEstimators)
+    {
+        std::vector<int> stage;
+        for (int i = 0; i < nrOfEstimators; i++)
+        {
+            if (stageOf[i] >= 0)
+            {
+                continue;
+            }
+            bool ready = true;
+            for (size_t d = 0; d < dependencies[i].size(); d++)
+            {
+                // Estimators are assigned to the stage being built only after it is complete
+                if (stageOf[dependencies[i][d]] < 0)
+                {
+                    ready = false;
+                    break;
+                }
+            }
+            if (ready)
+            {
+                stage.push_back(i);
+            }
+        }
+
+        if (stage.empty())
+        {
+            std::stringstream cyclic;
+            for (int i = 0; i < nrOfEstimators; i++)
+            {
+                if (stageOf[i] < 0)
+                {
+                    cyclic << " " << m_names[i];
+                }
+            }
+            yError("[EstimatorsScheduler::computeStages] Cyclic dependency between the estimators:%s", cyclic.str().c_str());
+            m_stages.clear();
+            return false;
+        }
+
+        for (size_t j = 0; j < stage.size(); j++)
+        {
+            stageOf[stage[j]] = static_cast<int>(m_stages.size());
+        }
+        nrOfAssigned += static_cast<int>(stage.size());
+        m_stages.push_back(stage);
+    }
+
+    return true;
+}
+
+bool EstimatorsScheduler::setDecimation(int estimator, int decimation, int phase)
+{
+    if (estimator < 0 || estimator >= static_cast<int>(m_estimators.size()))
+    {
+        yError("[EstimatorsScheduler::setDecimation] Estimator %d does not exist", estimator);
+        return false;
+    }
+    if (decimation < 1 || phase < 0 || phase >= decimation)
+    {
+        yError("[EstimatorsScheduler::setDecimation] Invalid decimation %d and phase %d for %s, phase must be between 0 and decimation-1",
+               decimation, phase, m_names[estimator].c_str());
+        return false;
+    }
+    m_decimations[estimator] = decimation;
+    m_phases[estimator] = phase;
+    return true;
+}
+
+bool EstimatorsScheduler::readEstimatorRate(yarp::os::ResourceFinder & rf,
+                                            const std::string & name,
+                                            int threadPeriod,
+                                            int & decimation,
+                                            int & phase,
+                                            int defaultPhase)
+{
+    decimation = 1;
+    phase = 0;
+
+    yarp::os::Bottle & params = rf.findGroup(name);
+    if ( params.isNull() )
+    {
+        return true;
+    }
+
+    if ( params.check("rate") && params.check("decimation") )
+    {
+        yError("[EstimatorsScheduler::readEstimatorRate] Only one of rate and decimation can be specified for %s", name.c_str());
+        return false;
+    }
+
+    if ( params.check("rate") )
+    {
+        double rate = params.find("rate").asDouble();
+        if ( rate <= 0.0 || threadPeriod <= 0 )
+        {
+            yError("[EstimatorsScheduler::readEstimatorRate] Invalid rate %f Hz for %s", rate, name.c_str());
+            return false;
+        }
+        double threadRate = 1000.0/threadPeriod;
+        decimation = static_cast<int>(floor(threadRate/rate + 0.5));
+        if ( decimation < 1 )
+        {
+            yWarning("[EstimatorsScheduler::readEstimatorRate] %s rate %.1f Hz is higher than the thread rate %.1f Hz, it will run at the thread rate",
+                     name.c_str(), rate, threadRate);
+            decimation = 1;
+        } else if ( fabs(threadRate/decimation - rate) > 1e-6*rate ) {
+            yWarning("[EstimatorsScheduler::readEstimatorRate] %s will run at %.2f Hz instead of %.2f Hz", name.c_str(), threadRate/decimation, rate);
+        }
+    } else if ( params.check("decimation") ) {
+        decimation = params.find("decimation").asInt();
+        if ( decimation < 1 )
+        {
+            yError("[EstimatorsScheduler::readEstimatorRate] Invalid decimation %d for %s", decimation, name.c_str());
+            return false;
+        }
+    }
+
+    if ( params.check("phase") )
+    {
+        phase = params.find("phase").asInt();
+        if ( phase < 0 || phase >= decimation )
+        {
+            yError("[EstimatorsScheduler::readEstimatorRate] Phase of %s must be between 0 and %d", name.c_str(), decimation-1);
+            return false;
+        }
+    } else {
+        phase = defaultPhase % decimation;
+    }
+
+    return true;
+}
+
+void EstimatorsScheduler::run()
+{
+    for (size_t s = 0; s < m_stages.size(); s++)
+    {
+        m_jobsMutex.lock();
+        m_currentJobs.clear();
+        for (size_t j = 0; j < m_stages[s].size(); j++)
+        {
+            int estimator = m_stages[s][j];
+            if ( static_cast<int>(m_cycle % m_decimations[estimator]) == m_phases[estimator] )
+            {
+                m_currentJobs.push_back(estimator);
+            }
+        }
+        m_nextJob = 0;
+        int nrOfJobs = static_cast<int>(m_currentJobs.size());
+        m_jobsMutex.unlock();
+
+        if (nrOfJobs == 0)
+        {
+            continue;
+        }
+
+        // Only the workers that can find an estimator to run are woken up
+        int nrOfHelpers = nrOfJobs - 1;
+        if (nrOfHelpers > static_cast<int>(m_workers.size()))
+        {
+            nrOfHelpers = static_cast<int>(m_workers.size());
+        }
+        for (int w = 0; w < nrOfHelpers; w++)
+        {
+            m_workers[w]->wakeUp();
+        }
+
+        runStageJobs();
+
+        for (int w = 0; w < nrOfHelpers; w++)
+        {
+            m_doneSemaphore.wait();
+        }
+    }
+    m_cycle++;
+}
+
+void EstimatorsScheduler::runStageJobs()
+{
+    while (true)
+    {
+        m_jobsMutex.lock();
+        int job = m_nextJob < static_cast<int>(m_currentJobs.size()) ? m_currentJobs[m_nextJob++] : -1;
+        m_jobsMutex.unlock();
+
+        if (job < 0)
+        {
+            return;
+        }
+        runEstimator(job);
+    }
+}
+
+void EstimatorsScheduler::runEstimator(int estimator)
+{
+    // Each estimator is run by a single thread per cycle, so its timing needs no locking
+    double start = yarp::os::Time::now();
+    m_estimators[estimator]->run();
+    double elapsed = yarp::os::Time::now() - start;
+
+    EstimatorTiming & timing = m_timings[estimator];
+    timing.last = elapsed;
+    timing.sum += elapsed;
+    timing.count++;
+    if (elapsed > timing.max)
+    {
+        timing.max = elapsed;
+    }
+}
+
+void EstimatorsScheduler::close()
+{
+    for (size_t w = 0; w < m_workers.size(); w++)
+    {
+        m_workers[w]->stop();
+        delete m_workers[w];
+    }
+    m_workers.clear();
+}
+
+std::string EstimatorsScheduler::getTimingStatisticsString() const
+{
+    std::stringstream statistics;
+    statistics << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < m_timings.size(); i++)
+    {
+        const EstimatorTiming & timing = m_timings[i];
+        double mean = timing.count > 0 ? timing.sum/timing.count : 0.0;
+        statistics << m_names[i]
+                   << " (1/" << m_decimations[i] << ")"
+                   << ": last " << 1000.0*timing.last
+                   << " ms, mean " << 1000.0*mean
+                   << " ms, max " << 1000.0*timing.max
+                   << " ms over " << timing.count << " runs\n";
+    }
+    return statistics.str();
+}
+
+void EstimatorsScheduler::resetTimingStatistics()
+{
+    EstimatorTiming zeroTiming = {0.0, 0.0, 0.0, 0};
+    m_timings.assign(m_timings.size(), zeroTiming);
+}
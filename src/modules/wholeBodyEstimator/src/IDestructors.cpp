@@ -4,4 +4,14 @@
 IEstimator::~IEstimator()
 {
     
-}
\ No newline at end of file
+}
+
+void IEstimator::getInputs(std::vector<std::string> &inputs) const
+{
+    inputs.clear();
+}
+
+void IEstimator::getOutputs(std::vector<std::string> &outputs) const
+{
+    outputs.clear();
+}
@@ -3,6 +3,8 @@
 
 #include "kdl/frames_io.hpp"
 #include <yarp/math/Math.h>
+#include <yarp/os/Time.h>
+#include <yarp/os/Stamp.h>
 
 using namespace yarp::os;
 using namespace yarp::sig;
@@ -11,7 +13,8 @@ using namespace iDynTree;
 
 REGISTERIMPL(LeggedOdometry);
 
-LeggedOdometry::LeggedOdometry() : m_className("LeggedOdometry")
+LeggedOdometry::LeggedOdometry() : frames_sequence_number(0),
+                                   m_className("LeggedOdometry")
 {
 }
 
@@ -287,15 +290,10 @@ bool LeggedOdometry::init(ResourceFinder &rf, wbi::iWholeBodySensors *wbs)
             frames_to_stream_indices.push_back(frame_index);
         }
         
-        buffer_bottles.resize(frames_to_stream.size());
-        
-        for(int i=0; i < buffer_bottles.size(); i++ )
+        for(int i=0; i < (int)frames_to_stream.size(); i++ )
         {
-            yInfo("wholeBodyDynamicsTree: streaming world position of frame %s",frames_to_stream[i].c_str());
-            buffer_bottles[i].addList();
+            yInfo("[LeggedOdometry::init] streaming world position of frame %s as frame %d",frames_to_stream[i].c_str(),i);
         }
-        
-        buffer_transform_matrix.resize(4,4);
     }
     
     
@@ -309,10 +307,9 @@ bool LeggedOdometry::init(ResourceFinder &rf, wbi::iWholeBodySensors *wbs)
         port_com = new BufferedPort<Vector>;
         port_com->open(std::string("/"+this->m_className+"/com:o"));
     }
-    //FIXME: Unused
     if( this->frames_streaming_enabled )
     {
-        port_frames = new BufferedPort<Property>;
+        port_frames = new BufferedPort<LeggedOdometryFrames>;
         port_frames->open(std::string("/"+this->m_className+"/frames:o"));
     }
     return true;
@@ -376,23 +373,39 @@ void LeggedOdometry::run()
 //            port_com->write();
 //        }
 //        
-//        if( this->frames_streaming_enabled )
-//        {
-//            // Stream frames in a property (highly inefficient! clean as soon as possible)
-//            Property& output = port_frames->prepare();
-//            
-//            for(int i =0; i < frames_to_stream.size(); i++ )
-//            {
-//                KDL::Frame frame_to_publish = odometry_helper.getWorldFrameTransform(frames_to_stream_indices[i]);
-//                
-//                KDLtoYarp_position(frame_to_publish,buffer_transform_matrix);
-//                
-//                buffer_bottles[i].get(0).asList()->read(buffer_transform_matrix);
-//                output.put(frames_to_stream[i].c_str(),buffer_bottles[i].get(0));
-//            }
-//            
-//            port_frames->write();
-//        }
+        if( this->frames_streaming_enabled )
+        {
+            // Stream the world pose of all the frames in a single binary message
+            LeggedOdometryFrames & output = port_frames->prepare();
+            output.resize(frames_to_stream_indices.size());
+            double now = yarp::os::Time::now();
+            output.setSequenceNumber(frames_sequence_number);
+            output.setTimestamp(now);
+
+            for(int i=0; i < (int)frames_to_stream_indices.size(); i++ )
+            {
+                KDL::Frame frame_to_publish = odometry_helper.getWorldFrameTransform(frames_to_stream_indices[i]);
+
+                double * world_H_frame = output.transform(i);
+                for(int row=0; row < 3; row++ )
+                {
+                    for(int col=0; col < 3; col++ )
+                    {
+                        world_H_frame[4*row+col] = frame_to_publish.M(row,col);
+                    }
+                    world_H_frame[4*row+3] = frame_to_publish.p(row);
+                }
+                world_H_frame[12] = 0.0;
+                world_H_frame[13] = 0.0;
+                world_H_frame[14] = 0.0;
+                world_H_frame[15] = 1.0;
+            }
+
+            yarp::os::Stamp stamp(frames_sequence_number, now);
+            port_frames->setEnvelope(stamp);
+            port_frames->write();
+            frames_sequence_number++;
+        }
         
         // save the current link considered as fixed by the odometry
         current_fixed_link_name = odometry_helper.getCurrentFixedLink();
@@ -412,6 +425,12 @@ void LeggedOdometry::readRobotStatus()
     m_joint_status->updateYarpBuffers();
 }
 
+void LeggedOdometry::getOutputs(std::vector<std::string> &outputs) const
+{
+    outputs.clear();
+    outputs.push_back("floatingBaseState");
+}
+
 void LeggedOdometry::release()
 {
     std::cerr<<"!!!!! release was called for LeggedOdometry " << std::endl;
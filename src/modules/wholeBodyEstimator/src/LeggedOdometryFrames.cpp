@@ -0,0 +1,89 @@
+#include "LeggedOdometryFrames.h"
+
+#include <yarp/os/Bottle.h>
+
+const int LeggedOdometryFrames::TRANSFORM_SIZE;
+
+// Number of elements of the Bottle compatible with the message: sequence number, timestamp, number of frames and transforms
+#define LEGGEDODOMETRYFRAMES_BOTTLE_SIZE 4
+
+LeggedOdometryFrames::LeggedOdometryFrames() : m_sequenceNumber(0),
+                                               m_timestamp(0.0)
+{
+}
+
+void LeggedOdometryFrames::resize(int nrOfFrames)
+{
+    m_transforms.resize(TRANSFORM_SIZE*nrOfFrames, 0.0);
+}
+
+bool LeggedOdometryFrames::read(yarp::os::ConnectionReader & connection)
+{
+    connection.convertTextMode();
+
+    if ( connection.expectInt() != BOTTLE_TAG_LIST ||
+         connection.expectInt() != LEGGEDODOMETRYFRAMES_BOTTLE_SIZE )
+    {
+        return false;
+    }
+
+    if ( connection.expectInt() != BOTTLE_TAG_INT )
+    {
+        return false;
+    }
+    m_sequenceNumber = connection.expectInt();
+
+    if ( connection.expectInt() != BOTTLE_TAG_DOUBLE )
+    {
+        return false;
+    }
+    m_timestamp = connection.expectDouble();
+
+    if ( connection.expectInt() != BOTTLE_TAG_INT )
+    {
+        return false;
+    }
+    int nrOfFrames = connection.expectInt();
+
+    if ( nrOfFrames < 0 ||
+         connection.expectInt() != (BOTTLE_TAG_LIST | BOTTLE_TAG_DOUBLE) ||
+         connection.expectInt() != TRANSFORM_SIZE*nrOfFrames )
+    {
+        return false;
+    }
+    resize(nrOfFrames);
+    if ( nrOfFrames > 0 )
+    {
+        connection.expectBlock(reinterpret_cast<char*>(&m_transforms[0]), m_transforms.size()*sizeof(double));
+    }
+
+    return !connection.isError();
+}
+
+bool LeggedOdometryFrames::write(yarp::os::ConnectionWriter & connection)
+{
+    connection.appendInt(BOTTLE_TAG_LIST);
+    connection.appendInt(LEGGEDODOMETRYFRAMES_BOTTLE_SIZE);
+
+    connection.appendInt(BOTTLE_TAG_INT);
+    connection.appendInt(m_sequenceNumber);
+
+    connection.appendInt(BOTTLE_TAG_DOUBLE);
+    connection.appendDouble(m_timestamp);
+
+    connection.appendInt(BOTTLE_TAG_INT);
+    connection.appendInt(getNrOfFrames());
+
+    // The transforms are sent as a single block, without copying them
+    connection.appendInt(BOTTLE_TAG_LIST | BOTTLE_TAG_DOUBLE);
+    connection.appendInt(static_cast<int>(m_transforms.size()));
+    if ( !m_transforms.empty() )
+    {
+        connection.appendExternalBlock(reinterpret_cast<const char*>(&m_transforms[0]), m_transforms.size()*sizeof(double));
+    }
+
+    // If the connection is in text mode, converts the message to text
+    connection.convertTextMode();
+
+    return !connection.isError();
+}
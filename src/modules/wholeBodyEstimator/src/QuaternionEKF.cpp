@@ -1,11 +1,20 @@
 #include "QuaternionEKF.h"
+#include "EstimatorsScheduler.h"
 
 REGISTERIMPL(QuaternionEKF);
 
 using namespace yarp::os;
 using namespace yarp::math;
 
-QuaternionEKF::QuaternionEKF() : m_className("QuaternionEKF")
+QuaternionEKF::QuaternionEKF() : m_className("QuaternionEKF"),
+                                 m_sysPdf(NULL),
+                                 m_sys_model(NULL),
+                                 m_measurement_uncertainty(NULL),
+                                 m_measPdf(NULL),
+                                 m_meas_model(NULL),
+                                 m_prior(NULL),
+                                 m_filter(NULL),
+                                 m_batchEstimation(false)
 {}
 
 bool QuaternionEKF::init(ResourceFinder &rf, wbi::iWholeBodySensors *wbs)
@@ -80,17 +89,57 @@ bool QuaternionEKF::init(ResourceFinder &rf, wbi::iWholeBodySensors *wbs)
         m_outputPortsList.push_back(floatingBaseRotPort);
     }
 
-    //FIXME: Temporary, while yarpWholeBodySensors is finished.
-    // Open sensor ports
-    sensorMeasPort = new yarp::os::Port;
-    readerPortStruct sensorDataPort;
-    std::string srcPort = std::string("/" + this->m_quaternionEKFParams.robotPrefix + "/right_leg/inertialMTB");
-    if ( !sensorDataPort.configurePort(this->m_className, std::string("rightFootMTBreader"), srcPort, sensorMeasPort) )
+    m_batchEstimation = !m_quaternionEKFParams.mtbBoardsIDs.empty();
+    if ( m_batchEstimation )
     {
-        yError("[QuaternionEKF::init] Could not connect to source port");
-        return false;
+        // Open publisher port for the estimates of all the boards (quaternions, one after the other)
+        // enum ORIENTATION_ESTIMATE_PORT_QUATERNION_BATCH
+        publisherPortStruct orientationEstimateBatchPort;
+        if ( !orientationEstimateBatchPort.configurePort(this->m_className, std::string("filteredOrientationBatch")) )
+        {
+            yError("[QuaternionEKF::init] Batch estimates port in quaternions could not be configured");
+            return false;
+        } else {
+            m_outputPortsList.push_back(orientationEstimateBatchPort);
+        }
+
+        // Open one sensor port for each part
+        for (unsigned int i = 0; i < m_quaternionEKFParams.mtbBoardsParts.size(); i++)
+        {
+            const std::string & part = m_quaternionEKFParams.mtbBoardsParts[i];
+            unsigned int partIndex = std::find(m_batchParts.begin(), m_batchParts.end(), part) - m_batchParts.begin();
+            if ( partIndex == m_batchParts.size() )
+            {
+                yarp::os::Port * partPort = new yarp::os::Port;
+                readerPortStruct partDataPort;
+                std::string srcPort = std::string("/" + this->m_quaternionEKFParams.robotPrefix + "/" + part + "/inertialMTB");
+                if ( !partDataPort.configurePort(this->m_className, part + "MTBreader", srcPort, partPort) )
+                {
+                    yError("[QuaternionEKF::init] Could not connect to source port %s", srcPort.c_str());
+                    return false;
+                } else {
+                    m_inputPortsList.push_back(partDataPort);
+                }
+                m_batchParts.push_back(part);
+                m_batchSensorPorts.push_back(partPort);
+            }
+            m_batchBoardsPart.push_back(partIndex);
+        }
+        yInfo("[QuaternionEKF::init] Estimating the orientation of %d MTB boards on %d parts",
+              (int)m_quaternionEKFParams.mtbBoardsIDs.size(), (int)m_batchParts.size());
     } else {
-        m_inputPortsList.push_back(sensorDataPort);
+        //FIXME: Temporary, while yarpWholeBodySensors is finished.
+        // Open sensor ports
+        sensorMeasPort = new yarp::os::Port;
+        readerPortStruct sensorDataPort;
+        std::string srcPort = std::string("/" + this->m_quaternionEKFParams.robotPrefix + "/right_leg/inertialMTB");
+        if ( !sensorDataPort.configurePort(this->m_className, std::string("rightFootMTBreader"), srcPort, sensorMeasPort) )
+        {
+            yError("[QuaternionEKF::init] Could not connect to source port");
+            return false;
+        } else {
+            m_inputPortsList.push_back(sensorDataPort);
+        }
     }
     
     std::string srcPortFloatingBasePose = "/LeggedOdometry/floatingbasestate:o";
@@ -117,17 +166,40 @@ bool QuaternionEKF::init(ResourceFinder &rf, wbi::iWholeBodySensors *wbs)
     m_prior_mu_vec.resize(m_quaternionEKFParams.stateSize);
     m_posterior_state.resize(m_quaternionEKFParams.stateSize);
 
-    // Create system model
-    createSystemModel();
+    if ( m_batchEstimation )
+    {
+        yInfo("[QuaternionEKF::init] Using the Eigen implementation of the filter for all the boards");
+        m_batchFilter.configure(m_quaternionEKFParams.mtbBoardsIDs.size(),
+                                m_quaternionEKFParams.period/1000.0,
+                                m_quaternionEKFParams.sigmaGyro,
+                                m_quaternionEKFParams.sigmaMeasurementNoise,
+                                m_quaternionEKFParams.priorCovariance,
+                                GRAVITY_NOMINAL);
+        m_posterior_state = 0.0;
+        m_posterior_state(1) = 1.0;
+    } else if ( m_quaternionEKFParams.useEigenFilter )
+    {
+        yInfo("[QuaternionEKF::init] Using the Eigen implementation of the filter");
+        m_eigenFilter.configure(m_quaternionEKFParams.period/1000.0,
+                                m_quaternionEKFParams.sigmaGyro,
+                                m_quaternionEKFParams.sigmaMeasurementNoise,
+                                m_quaternionEKFParams.priorCovariance,
+                                GRAVITY_NOMINAL);
+        m_posterior_state = 0.0;
+        m_posterior_state(1) = 1.0;
+    } else {
+        // Create system model
+        createSystemModel();
 
-    // Create measurement model
-    createMeasurementModel();
+        // Create measurement model
+        createMeasurementModel();
 
-    // Setting priors
-    setPriors();
+        // Setting priors
+        setPriors();
 
-    // Create filter
-    createFilter();
+        // Create filter
+        createFilter();
+    }
 
     // Initialize measurement object
     measurements.linAcc.resize(3,0.0);
@@ -188,63 +260,60 @@ bool QuaternionEKF::init(ResourceFinder &rf, wbi::iWholeBodySensors *wbs)
 
 void QuaternionEKF::run()
 {
-    // Read sensor data
-//    std::cerr << "[QuaternionEKF] Reading sensor data ... " << std::endl;
-    if ( !readSensorData(measurements) )
+    if ( m_batchEstimation )
     {
-        yWarning("[QuaternionEKF::run] SENSOR DATA COULD NOT BE READ!");
-    } else {
-        //yInfo("[QuaternionEKF::run] Parsed sensor data: \n Acc [m/s^2]: \t%s \n Ang Vel [deg/s]: \t%s \n",  (measurements.linAcc).toString().c_str(), (measurements.angVel).toString().c_str());
-    }
-
-    // Copy ang velocity data from a yarp vector into a ColumnVector
-    MatrixWrapper::ColumnVector input(measurements.angVel.data(),m_quaternionEKFParams.inputSize);
-    // Copy accelerometer data from a yarp vector into a ColumnVector
-    MatrixWrapper::ColumnVector measurement(measurements.linAcc.data(),m_quaternionEKFParams.measurementSize);
-
-    // Noise gaussian
-    // System Noise Mean
-    //TODO: [NOT SURE] This mean changes!!!
-    MatrixWrapper::ColumnVector sys_noise_mu(m_quaternionEKFParams.stateSize);
-    sys_noise_mu = 0.0;
-
-    /**************** System Noise Covariance *********************************************************/
-    MatrixWrapper::Matrix Xi(m_quaternionEKFParams.stateSize, m_quaternionEKFParams.inputSize);
-    XiOperator(m_posterior_state, &Xi);
-    MatrixWrapper::SymmetricMatrix sys_noise_cov(m_quaternionEKFParams.stateSize);
-    sys_noise_cov = 0.0;
-    // NOTE m_sigma_gyro must be small, ||ek|| = 10e-3 rad/sec
-    MatrixWrapper::Matrix Sigma_gyro(m_quaternionEKFParams.inputSize,m_quaternionEKFParams.inputSize);
-    Sigma_gyro = 0.0;
-    Sigma_gyro(1,1) = Sigma_gyro(2,2) = Sigma_gyro(3,3) = m_quaternionEKFParams.sigmaGyro;
-    MatrixWrapper::Matrix tmp = Xi*Sigma_gyro*Xi.transpose();
-    //NOTE: on 30-07-2015 I commented the following lines because making this matrix symmetric this way does not make much sense from a theoretical point of view. I'd rather add a term such as alpha*I_4x4
-    //         MatrixWrapper::SymmetricMatrix tmpSym(m_state_size);
-    //         tmp.convertToSymmetricMatrix(tmpSym);
-    sys_noise_cov = (MatrixWrapper::SymmetricMatrix) tmp*pow(m_quaternionEKFParams.period/(1000.0*2.0),2);
-    //NOTE: Next line is setting system noise covariance matrix to a constant diagonal matrix
-    //         sys_noise_cov = 0.0; sys_noise_cov(1,1) = sys_noise_cov (2,2) = sys_noise_cov(3,3) = sys_noise_cov(4,4) = 0.000001;
-    /**************** ENDS System Noise Covariance *******************************************************/
-
-    //std::cout << "System covariance matrix will be: " << std::endl << sys_noise_cov << std::endl;
+        if ( !readBatchSensorData() )
+        {
+            yWarning("[QuaternionEKF::run] SENSOR DATA COULD NOT BE READ!");
+        }
+        if ( m_batchFilter.update() > 0 )
+        {
+            yError("[QuaternionEKF::run] Update step of the Kalman Filter could not be performed for some boards\n");
+        }
 
-    //FIXME: Remove the line below as the mean pretty much never changes and remains zero
-    //m_sysPdf->AdditiveNoiseMuSet(sys_noise_mu);
-    m_sysPdf->AdditiveNoiseSigmaSet(sys_noise_cov);
+        // Writing to port the estimated quaternions of all the boards
+        const wholeBodyEstimator::quaternionEKFEigenFilterBatch::Matrix4xN & states = m_batchFilter.getStates();
+        yarp::sig::Vector& tmpPortBatch = m_outputPortsList[ORIENTATION_ESTIMATE_PORT_QUATERNION_BATCH].outputPort->prepare();
+        if ( tmpPortBatch.size() != (size_t)states.size() )
+            tmpPortBatch.resize(states.size());
+        Eigen::Map<wholeBodyEstimator::quaternionEKFEigenFilterBatch::Matrix4xN>(tmpPortBatch.data(), 4, states.cols()) = states;
+        m_outputPortsList[ORIENTATION_ESTIMATE_PORT_QUATERNION_BATCH].outputPort->write();
+
+        // The first board is used for the single board outputs
+        for (unsigned int i=0; i<3; i++) {
+            measurements.linAcc(i) = m_batchFilter.linearAccelerations()(i,0);
+            measurements.angVel(i) = m_batchFilter.angularVelocities()(i,0);
+        }
+        for (unsigned int i=0; i<4; i++) {
+            m_posterior_state(i+1) = states(i,0);
+        }
+    } else {
+        // Read sensor data
+//        std::cerr << "[QuaternionEKF] Reading sensor data ... " << std::endl;
+        if ( !readSensorData(measurements) )
+        {
+            yWarning("[QuaternionEKF::run] SENSOR DATA COULD NOT BE READ!");
+        } else {
+            //yInfo("[QuaternionEKF::run] Parsed sensor data: \n Acc [m/s^2]: \t%s \n Ang Vel [deg/s]: \t%s \n",  (measurements.linAcc).toString().c_str(), (measurements.angVel).toString().c_str());
+        }
 
-    if(!m_filter->Update(m_sys_model, input, m_meas_model, measurement))
-    {
-        yError("[QuaternionEKF::run] Update step of the Kalman Filter could not be performed\n");
+        if ( m_quaternionEKFParams.useEigenFilter )
+        {
+            if ( !m_eigenFilter.update(measurements.angVel.data(), measurements.linAcc.data()) )
+            {
+                yError("[QuaternionEKF::run] Update step of the Kalman Filter could not be performed\n");
+            }
+            // Posterior Expectation
+            const wholeBodyEstimator::quaternionEKFEigenFilter::Vector4 & state = m_eigenFilter.getState();
+            for (unsigned int i=0; i<4; i++) {
+                m_posterior_state(i+1) = state(i);
+            }
+        } else {
+            updateBFLFilter();
+        }
     }
 
-    // Get the posterior of the updated filter. Result of all the system model and meaurement information
-    BFL::Pdf<BFL::ColumnVector> * posterior = m_filter->PostGet();
-    // Posterior Expectation
-    m_posterior_state = posterior->ExpectedValueGet();
     MatrixWrapper::Quaternion expectedValueQuat(m_posterior_state);
-    // Posterior Covariance
-    MatrixWrapper::SymmetricMatrix covariance(m_quaternionEKFParams.stateSize);
-    covariance = posterior->CovarianceGet();
     //std::cout << "[QuaternionEKF::run] Posterior Mean: " << expectedValueQuat << std::endl;
     //std::cout << "Posterior Covariance: " << posterior->CovarianceGet() << std::endl;
     MatrixWrapper::Quaternion tmpQuat(expectedValueQuat);
@@ -252,23 +321,22 @@ void QuaternionEKF::run()
     expectedValueQuat.conjugate(tmpQuat);
     tmpQuat.getEulerAngles(std::string("xyz"), eulerAngles);
     //std::cout << "[QuaternionEKF::run] Posterior Mean in Euler Angles: " << (180/PI)*eulerAngles  << std::endl;
-    // Publish results to port
-    yarp::sig::Vector tmpVec(m_quaternionEKFParams.stateSize);
-    for (unsigned int i=1; i<m_posterior_state.size()+1; i++) {
-        tmpVec(i-1) = m_posterior_state(i);
-    }
     // Publish Euler Angles estimate to port
     //TODO: Check why I need to do this multiplication in this particular way.
-    yarp::sig::Vector tmpEuler(3);
-    for (unsigned int i=1; i<eulerAngles.rows()+1; i++)
-        tmpEuler(i-1) = eulerAngles(i)*(180/PI);
     // Writing to port the full estimated orientation in Euler angles (xyz order)
     yarp::sig::Vector& tmpPortEuler = m_outputPortsList[ORIENTATION_ESTIMATE_PORT_EULER].outputPort->prepare();
-    tmpPortEuler = tmpEuler;
+    if ( tmpPortEuler.size() != (size_t)eulerAngles.rows() )
+        tmpPortEuler.resize(eulerAngles.rows());
+    for (unsigned int i=1; i<eulerAngles.rows()+1; i++)
+        tmpPortEuler(i-1) = eulerAngles(i)*(180/PI);
     m_outputPortsList[ORIENTATION_ESTIMATE_PORT_EULER].outputPort->write();
     // Writing to port the full estimated quaternion
     yarp::sig::Vector& tmpPortRef = m_outputPortsList[ORIENTATION_ESTIMATE_PORT_QUATERNION].outputPort->prepare();
-    tmpPortRef = tmpVec;
+    if ( tmpPortRef.size() != m_quaternionEKFParams.stateSize )
+        tmpPortRef.resize(m_quaternionEKFParams.stateSize);
+    for (unsigned int i=1; i<m_posterior_state.size()+1; i++) {
+        tmpPortRef(i-1) = m_posterior_state(i);
+    }
     m_outputPortsList[ORIENTATION_ESTIMATE_PORT_QUATERNION].outputPort->write();
 
 
@@ -378,6 +446,69 @@ void QuaternionEKF::run()
     }
 }
 
+void QuaternionEKF::updateBFLFilter()
+{
+    // Copy ang velocity data from a yarp vector into a ColumnVector
+    MatrixWrapper::ColumnVector input(measurements.angVel.data(),m_quaternionEKFParams.inputSize);
+    // Copy accelerometer data from a yarp vector into a ColumnVector
+    MatrixWrapper::ColumnVector measurement(measurements.linAcc.data(),m_quaternionEKFParams.measurementSize);
+
+    // Noise gaussian
+    // System Noise Mean
+    //TODO: [NOT SURE] This mean changes!!!
+    MatrixWrapper::ColumnVector sys_noise_mu(m_quaternionEKFParams.stateSize);
+    sys_noise_mu = 0.0;
+
+    /**************** System Noise Covariance *********************************************************/
+    MatrixWrapper::Matrix Xi(m_quaternionEKFParams.stateSize, m_quaternionEKFParams.inputSize);
+    XiOperator(m_posterior_state, &Xi);
+    MatrixWrapper::SymmetricMatrix sys_noise_cov(m_quaternionEKFParams.stateSize);
+    sys_noise_cov = 0.0;
+    // NOTE m_sigma_gyro must be small, ||ek|| = 10e-3 rad/sec
+    MatrixWrapper::Matrix Sigma_gyro(m_quaternionEKFParams.inputSize,m_quaternionEKFParams.inputSize);
+    Sigma_gyro = 0.0;
+    Sigma_gyro(1,1) = Sigma_gyro(2,2) = Sigma_gyro(3,3) = m_quaternionEKFParams.sigmaGyro;
+    MatrixWrapper::Matrix tmp = Xi*Sigma_gyro*Xi.transpose();
+    //NOTE: on 30-07-2015 I commented the following lines because making this matrix symmetric this way does not make much sense from a theoretical point of view. I'd rather add a term such as alpha*I_4x4
+    //         MatrixWrapper::SymmetricMatrix tmpSym(m_state_size);
+    //         tmp.convertToSymmetricMatrix(tmpSym);
+    sys_noise_cov = (MatrixWrapper::SymmetricMatrix) tmp*pow(m_quaternionEKFParams.period/(1000.0*2.0),2);
+    //NOTE: Next line is setting system noise covariance matrix to a constant diagonal matrix
+    //         sys_noise_cov = 0.0; sys_noise_cov(1,1) = sys_noise_cov (2,2) = sys_noise_cov(3,3) = sys_noise_cov(4,4) = 0.000001;
+    /**************** ENDS System Noise Covariance *******************************************************/
+
+    //std::cout << "System covariance matrix will be: " << std::endl << sys_noise_cov << std::endl;
+
+    //FIXME: Remove the line below as the mean pretty much never changes and remains zero
+    //m_sysPdf->AdditiveNoiseMuSet(sys_noise_mu);
+    m_sysPdf->AdditiveNoiseSigmaSet(sys_noise_cov);
+
+    if(!m_filter->Update(m_sys_model, input, m_meas_model, measurement))
+    {
+        yError("[QuaternionEKF::run] Update step of the Kalman Filter could not be performed\n");
+    }
+
+    // Get the posterior of the updated filter. Result of all the system model and meaurement information
+    BFL::Pdf<BFL::ColumnVector> * posterior = m_filter->PostGet();
+    // Posterior Expectation
+    m_posterior_state = posterior->ExpectedValueGet();
+}
+
+void QuaternionEKF::getInputs(std::vector<std::string> &inputs) const
+{
+    inputs.clear();
+    if ( m_quaternionEKFParams.floatingBaseAttitude )
+    {
+        inputs.push_back("floatingBaseState");
+    }
+}
+
+void QuaternionEKF::getOutputs(std::vector<std::string> &outputs) const
+{
+    outputs.clear();
+    outputs.push_back("mtbOrientation");
+}
+
 void QuaternionEKF::release()
 {
     yInfo("[QuaternionEKF::release] Destroying QuaternionEKF");
@@ -477,6 +608,37 @@ bool QuaternionEKF::readEstimatorParams(yarp::os::ResourceFinder &rf, quaternion
         estimatorParams.priorCovariance = botParams.find("prior_cov_state").asDouble();
         estimatorParams.muGyroNoise = botParams.find("mu_gyro_noise").asDouble();
         estimatorParams.floatingBaseAttitude = botParams.find("floating_base_attitude").asBool();
+        std::string filterBackend = botParams.check("filter_backend", yarp::os::Value("bfl")).asString();
+        if ( filterBackend != "bfl" && filterBackend != "eigen" )
+        {
+            yError("[QuaternionEKF::readEstimatorParams] Unknown filter_backend %s, expected bfl or eigen", filterBackend.c_str());
+            return false;
+        }
+        estimatorParams.useEigenFilter = (filterBackend == "eigen");
+
+        // Optional list of MTB boards to be estimated in batch, e.g. ((right_leg 33) (right_arm 25))
+        estimatorParams.mtbBoardsParts.clear();
+        estimatorParams.mtbBoardsIDs.clear();
+        if ( botParams.check("mtb_boards") )
+        {
+            yarp::os::Bottle * boardsBottle = botParams.find("mtb_boards").asList();
+            if ( !boardsBottle || boardsBottle->size() == 0 )
+            {
+                yError("[QuaternionEKF::readEstimatorParams] mtb_boards should be a list of (part boardID) pairs");
+                return false;
+            }
+            for (int i = 0; i < boardsBottle->size(); i++)
+            {
+                yarp::os::Bottle * board = boardsBottle->get(i).asList();
+                if ( !board || board->size() != 2 || !board->get(0).isString() || !board->get(1).isInt() )
+                {
+                    yError("[QuaternionEKF::readEstimatorParams] Malformed element %d of mtb_boards, expected (part boardID)", i);
+                    return false;
+                }
+                estimatorParams.mtbBoardsParts.push_back(board->get(0).asString());
+                estimatorParams.mtbBoardsIDs.push_back(board->get(1).asInt());
+            }
+        }
         estimatorParams.rot_from_ft_to_acc_bottle = new yarp::os::Bottle(*botParams.find("rot_from_ft_to_acc").asList());
     }
 
@@ -488,6 +650,13 @@ bool QuaternionEKF::readEstimatorParams(yarp::os::ResourceFinder &rf, quaternion
         return false;
     } else {
         estimatorParams.period = botParams.find("period").asInt();
+        // The filter is run once every decimation periods of the thread
+        int decimation, phase;
+        if ( !EstimatorsScheduler::readEstimatorRate(rf, "QuaternionEKF", estimatorParams.period, decimation, phase) )
+        {
+            return false;
+        }
+        estimatorParams.period *= decimation;
         estimatorParams.robotPrefix = botParams.find("robot").asString();
         estimatorParams.streamMeasurements = botParams.find("stream_measurements").asBool();
     }
@@ -627,6 +796,50 @@ bool QuaternionEKF::extractMTBDatafromPort(int boardNum, measurementsStruct &mea
     return true;
 }
 
+bool QuaternionEKF::readBatchSensorData()
+{
+    bool ok = true;
+    for (unsigned int partIndex = 0; partIndex < m_batchSensorPorts.size(); partIndex++)
+    {
+        if ( !m_batchSensorPorts[partIndex]->read(m_batchRawMeasurement) ) {
+            yError("[QuaternionEKF::readBatchSensorData] There was an error trying to read from the MTB port of %s", m_batchParts[partIndex].c_str());
+            ok = false;
+        } else {
+            extractMTBBatchData(partIndex);
+        }
+    }
+    return ok;
+}
+
+void QuaternionEKF::extractMTBBatchData(int partIndex)
+{
+    wholeBodyEstimator::quaternionEKFEigenFilterBatch::Matrix3xN & linAccs = m_batchFilter.linearAccelerations();
+    wholeBodyEstimator::quaternionEKFEigenFilterBatch::Matrix3xN & angVels = m_batchFilter.angularVelocities();
+    const double * tmp = m_batchRawMeasurement.data();
+    const int size = m_batchRawMeasurement.size();
+
+    // First two elements of the vector can be skipped, then a package is expected every MTB_PORT_DATA_PACKAGE_OFFSET elements
+    for (int k = 2; k + 5 < size; k += MTB_PORT_DATA_PACKAGE_OFFSET)
+    {
+        for (unsigned int board = 0; board < m_batchBoardsPart.size(); board++)
+        {
+            if ( m_batchBoardsPart[board] != partIndex || tmp[k] != m_quaternionEKFParams.mtbBoardsIDs[board] )
+                continue;
+            //  If sensor from board is an accelerometer
+            if ( tmp[k + 1] == 1.0 ) {
+                linAccs(0,board) = CONVERSION_FACTOR_ACC*tmp[k + 3];
+                linAccs(1,board) = CONVERSION_FACTOR_ACC*tmp[k + 4];
+                linAccs(2,board) = CONVERSION_FACTOR_ACC*tmp[k + 5];
+            } else if ( tmp[k + 1] == 2.0 ) {
+                // If sensor from board is a gyroscope
+                angVels(0,board) = PI/180*CONVERSION_FACTOR_GYRO*tmp[k + 3];
+                angVels(1,board) = PI/180*CONVERSION_FACTOR_GYRO*tmp[k + 4];
+                angVels(2,board) = PI/180*CONVERSION_FACTOR_GYRO*tmp[k + 5];
+            }
+        }
+    }
+}
+
 void QuaternionEKF::XiOperator ( MatrixWrapper::ColumnVector quat, MatrixWrapper::Matrix* Xi )
 {
     //     In  Matlab language this would be:
@@ -7,10 +7,14 @@ using namespace yarp::math;
 using namespace wbi;
 using namespace iDynTree;
 
+#define ESTIMATORS_TIMING_PRINT_PERIOD 5.0
+
 WholeBodyEstimatorThread::WholeBodyEstimatorThread (ResourceFinder &rf, iWholeBodySensors* wbs, int period) : RateThread(period),
                                                                                                               m_rfCopy(rf),
                                                                                                               m_wbs(wbs),
-                                                                                                              m_run_mutex_acquired(false)
+                                                                                                              m_run_mutex_acquired(false),
+                                                                                                              m_verbose(false),
+                                                                                                              m_lastTimingPrintTime(-1.0)
 {
     m_joint_status = 0;
 }
@@ -48,7 +52,41 @@ bool WholeBodyEstimatorThread::threadInit()
         }
         k++;
     }
-    
+
+    // Number of worker threads running the independent estimators. By default one less than the number of estimators
+    // that can run concurrently, as this thread runs estimators as well.
+    yarp::os::Property moduleParams;
+    moduleParams.fromString(m_rfCopy.findGroup("module_parameters").tail().toString());
+    int nrOfWorkers = moduleParams.check("estimator_workers") ? moduleParams.find("estimator_workers").asInt() : -1;
+    m_verbose = moduleParams.check("verbose") && moduleParams.find("verbose").asBool();
+
+    if ( !m_scheduler.configure(m_estimatorsList, m_estimatorsNames, nrOfWorkers) )
+    {
+        yError("[WholeBodyEstimatorThread::threadInit()] Could not schedule the estimators");
+        return false;
+    }
+
+    // Rate of each estimator. The estimators slower than the thread without an explicit phase are
+    // spread over different thread periods, so that they do not all run in the same one.
+    int nrOfDecimatedEstimators = 0;
+    for (size_t i = 0; i < m_estimatorsNames.size(); i++)
+    {
+        int decimation, phase;
+        if ( !EstimatorsScheduler::readEstimatorRate(m_rfCopy, m_estimatorsNames[i], static_cast<int>(getRate()),
+                                                      decimation, phase, nrOfDecimatedEstimators)
+             || !m_scheduler.setDecimation(static_cast<int>(i), decimation, phase) )
+        {
+            yError("[WholeBodyEstimatorThread::threadInit()] Invalid rate for estimator %s", m_estimatorsNames[i].c_str());
+            return false;
+        }
+        if ( decimation > 1 )
+        {
+            yInfo("[WholeBodyEstimatorThread::threadInit()] %s runs every %d periods with phase %d", m_estimatorsNames[i].c_str(), decimation, phase);
+            nrOfDecimatedEstimators++;
+        }
+    }
+    m_lastTimingPrintTime = yarp::os::Time::now();
+
     return true;
 }
 
@@ -64,21 +102,29 @@ void WholeBodyEstimatorThread::run()
     
     this->m_run_mutex_acquired = true;
     
-    // run each estimator
-    std::vector<IEstimator*>::iterator it;
-    for (it = this->m_estimatorsList.begin(); it < this->m_estimatorsList.end(); ++it)
-    {
-        (*it)->run();
-    }
+    // run each estimator, the independent ones concurrently
+    m_scheduler.run();
 
     this->m_run_mutex_acquired = false;
     run_mutex.unlock();
+
+    if ( m_verbose )
+    {
+        double now = yarp::os::Time::now();
+        if ( now - m_lastTimingPrintTime >= ESTIMATORS_TIMING_PRINT_PERIOD )
+        {
+            yInfo("[WholeBodyEstimatorThread::run] Estimators timing:\n%s", m_scheduler.getTimingStatisticsString().c_str());
+            m_lastTimingPrintTime = now;
+        }
+    }
     
 }
 
 void WholeBodyEstimatorThread::threadRelease()
 {
     std::cerr << "[wholeBodyEstimatorThread::threadRelease] Starting thread closure... " << std::endl;
+    // Stop the worker threads before releasing the estimators
+    m_scheduler.close();
     // Delete each estimator
     unsigned int k = 1;
     std::vector<IEstimator*>::iterator it;
@@ -126,7 +172,14 @@ bool WholeBodyEstimatorThread::fillEstimatorsList()
     {
         // This line is pretty much doing:
         // m_estimatorList[i] = new <class-name-from-map>
-        m_estimatorsList.push_back( EstimatorsFactory::create(it->first) );
+        IEstimator* estimator = EstimatorsFactory::create(it->first);
+        if ( !estimator )
+        {
+            yError("[WholeBodyEstimatorThread::fillEstimatorsList] Unknown estimator %s", it->first.c_str());
+            return false;
+        }
+        m_estimatorsList.push_back( estimator );
+        m_estimatorsNames.push_back( it->first );
     }
     
     return true;
@@ -0,0 +1,146 @@
+#include "quaternionEKFEigenFilter.h"
+
+namespace wholeBodyEstimator
+{
+    quaternionEKFEigenFilter::quaternionEKFEigenFilter() : m_period(0.01),
+                                                           m_sigmaGyro(0.0),
+                                                           m_sigmaMeasurementNoise(0.0),
+                                                           m_priorCovariance(1.0),
+                                                           m_gravity(0.0)
+    {
+        setPriors();
+    }
+
+    void quaternionEKFEigenFilter::configure(double periodInSeconds,
+                                             double sigmaGyro,
+                                             double sigmaMeasurementNoise,
+                                             double priorCovariance,
+                                             double gravity)
+    {
+        m_period = periodInSeconds;
+        m_sigmaGyro = sigmaGyro;
+        m_sigmaMeasurementNoise = sigmaMeasurementNoise;
+        m_priorCovariance = priorCovariance;
+        m_gravity = gravity;
+        setPriors();
+    }
+
+    void quaternionEKFEigenFilter::setPriors()
+    {
+        // Equivalent to a zero rotation
+        m_state << 1.0, 0.0, 0.0, 0.0;
+        m_covariance = m_priorCovariance*Matrix4x4::Identity();
+    }
+
+    bool quaternionEKFEigenFilter::update(const double * angVel, const double * linAcc)
+    {
+        const double q0 = m_state(0), q1 = m_state(1), q2 = m_state(2), q3 = m_state(3);
+
+        /**************** System Noise Covariance *********************************************************/
+        // Xi = [       -qk(2:4,:)'           ;
+        //       qk(1)*eye(3) + S(qk(2:4,:)) ];
+        m_Xi << -q1, -q2, -q3,
+                 q0, -q3,  q2,
+                 q3,  q0, -q1,
+                -q2,  q1,  q0;
+        // Xi*Sigma_gyro*Xi' with Sigma_gyro = sigma_gyro*eye(3)
+        m_systemNoiseCovariance.noalias() = m_Xi*m_Xi.transpose();
+        m_systemNoiseCovariance *= m_sigmaGyro*(m_period/2.0)*(m_period/2.0);
+
+        /**************** Prediction *********************************************************************/
+        // Discrete time transition matrix A = I + 0.5*T*Omega(w)
+        const double halfPeriod = 0.5*m_period;
+        const double wx = halfPeriod*angVel[0], wy = halfPeriod*angVel[1], wz = halfPeriod*angVel[2];
+        m_transitionMatrix << 1.0, -wx, -wy, -wz,
+                               wx, 1.0,  wz, -wy,
+                               wy, -wz, 1.0,  wx,
+                               wz,  wy, -wx, 1.0;
+        m_predictedState.noalias() = m_transitionMatrix*m_state;
+        m_predictedState.normalize();
+
+        m_tmpCovariance.noalias() = m_transitionMatrix*m_covariance;
+        m_covariance.noalias() = m_tmpCovariance*m_transitionMatrix.transpose();
+        m_covariance += m_systemNoiseCovariance;
+        m_state = m_predictedState;
+
+        /**************** Update *************************************************************************/
+        // Accelerometer measurement model h(q) = Q(q)*[0 0 g]' and its jacobian
+        const double p0 = m_state(0), p1 = m_state(1), p2 = m_state(2), p3 = m_state(3);
+        m_predictedMeasurement << 2.0*(p1*p3 + p0*p2),
+                                  2.0*(p2*p3 - p0*p1),
+                                  2.0*(p0*p0 + p3*p3) - 1.0;
+        m_predictedMeasurement *= m_gravity;
+
+        m_measurementJacobian <<  p2, p3, p0,    p1,
+                                 -p1, -p0, p3,   p2,
+                                 2.0*p0, 0.0, 0.0, 2.0*p3;
+        m_measurementJacobian *= 2.0*m_gravity;
+
+        // K = P*H'*(H*P*H' + R)^-1
+        m_PHt.noalias() = m_covariance*m_measurementJacobian.transpose();
+        m_innovationCovariance.noalias() = m_measurementJacobian*m_PHt;
+        m_innovationCovariance.diagonal().array() += m_sigmaMeasurementNoise;
+
+        Matrix3x3 innovationCovarianceInverse;
+        bool invertible = false;
+        m_innovationCovariance.computeInverseWithCheck(innovationCovarianceInverse, invertible);
+        if (!invertible)
+        {
+            return false;
+        }
+        m_gain.noalias() = m_PHt*innovationCovarianceInverse;
+
+        // x = x + K*(z - h(x))
+        m_innovation << linAcc[0] - m_predictedMeasurement(0),
+                        linAcc[1] - m_predictedMeasurement(1),
+                        linAcc[2] - m_predictedMeasurement(2);
+        m_state.noalias() += m_gain*m_innovation;
+
+        // P = P - K*H*P, keeping the upper triangular part as BFL does when converting to a symmetric matrix
+        m_covariance.noalias() -= m_gain*m_PHt.transpose();
+        for (int i = 1; i < 4; i++)
+        {
+            for (int j = 0; j < i; j++)
+            {
+                m_covariance(i,j) = m_covariance(j,i);
+            }
+        }
+
+        return true;
+    }
+
+    void quaternionEKFEigenFilterBatch::configure(int nrOfFilters,
+                                                  double periodInSeconds,
+                                                  double sigmaGyro,
+                                                  double sigmaMeasurementNoise,
+                                                  double priorCovariance,
+                                                  double gravity)
+    {
+        m_filters.resize(nrOfFilters);
+        for (int i = 0; i < nrOfFilters; i++)
+        {
+            m_filters[i].configure(periodInSeconds, sigmaGyro, sigmaMeasurementNoise, priorCovariance, gravity);
+        }
+        m_angularVelocities.setZero(3, nrOfFilters);
+        m_linearAccelerations.setZero(3, nrOfFilters);
+        m_states.resize(4, nrOfFilters);
+        for (int i = 0; i < nrOfFilters; i++)
+        {
+            m_states.col(i) = m_filters[i].getState();
+        }
+    }
+
+    int quaternionEKFEigenFilterBatch::update()
+    {
+        int nrOfFailures = 0;
+        for (size_t i = 0; i < m_filters.size(); i++)
+        {
+            if (!m_filters[i].update(m_angularVelocities.col(i).data(), m_linearAccelerations.col(i).data()))
+            {
+                nrOfFailures++;
+            }
+            m_states.col(i) = m_filters[i].getState();
+        }
+        return nrOfFailures;
+    }
+}